@@ -0,0 +1,86 @@
+#include <cage-core/entities.h>
+
+#include "game.h"
+
+namespace
+{
+	constexpr uint32 Categories = (uint32)ChurnCategoryEnum::Total;
+
+	uint32 tickCreated[Categories];
+	uint32 tickDestroyed[Categories];
+
+	template<ChurnCategoryEnum C>
+	void entityAdded(Entity *)
+	{
+		tickCreated[(uint32)C]++;
+	}
+
+	template<ChurnCategoryEnum C>
+	void entityRemoved(Entity *)
+	{
+		tickDestroyed[(uint32)C]++;
+	}
+
+	struct ChurnListeners
+	{
+		EventListener<void(Entity *)> added;
+		EventListener<void(Entity *)> removed;
+
+		template<ChurnCategoryEnum C>
+		void attach(EntityGroup *group)
+		{
+			added.attach(group->entityAdded);
+			added.bind<&entityAdded<C>>();
+			removed.attach(group->entityRemoved);
+			removed.bind<&entityRemoved<C>>();
+		}
+	};
+
+	ChurnListeners listeners[Categories];
+
+	void engineInit()
+	{
+		listeners[(uint32)ChurnCategoryEnum::Entities].attach<ChurnCategoryEnum::Entities>(engineEntities()->group());
+		listeners[(uint32)ChurnCategoryEnum::Monsters].attach<ChurnCategoryEnum::Monsters>(MonsterComponent::component->group());
+		listeners[(uint32)ChurnCategoryEnum::Shots].attach<ChurnCategoryEnum::Shots>(ShotComponent::component->group());
+		listeners[(uint32)ChurnCategoryEnum::Powerups].attach<ChurnCategoryEnum::Powerups>(PowerupComponent::component->group());
+		listeners[(uint32)ChurnCategoryEnum::Timeouts].attach<ChurnCategoryEnum::Timeouts>(TimeoutComponent::component->group());
+		listeners[(uint32)ChurnCategoryEnum::LightSources].attach<ChurnCategoryEnum::LightSources>(LightSourceComponent::component->group());
+		listeners[(uint32)ChurnCategoryEnum::Lights].attach<ChurnCategoryEnum::Lights>(LightComponent::component->group());
+		listeners[(uint32)ChurnCategoryEnum::Sounds].attach<ChurnCategoryEnum::Sounds>(SoundComponent::component->group());
+		listeners[(uint32)ChurnCategoryEnum::Renders].attach<ChurnCategoryEnum::Renders>(RenderComponent::component->group());
+	}
+
+	void engineUpdate()
+	{
+		DEGRID_SYSTEM_TIMING("churn");
+
+		for (uint32 i = 0; i < Categories; i++)
+		{
+			const uint32 c = tickCreated[i], d = tickDestroyed[i];
+			tickCreated[i] = tickDestroyed[i] = 0;
+			statistics.churnCreated[i] += c;
+			statistics.churnDestroyed[i] += d;
+			statistics.churnCreatedCurrent[i] = c;
+			statistics.churnDestroyedCurrent[i] = d;
+			statistics.churnCreatedPeak[i] = max(statistics.churnCreatedPeak[i], c);
+			statistics.churnDestroyedPeak[i] = max(statistics.churnDestroyedPeak[i], d);
+			statistics.churnCreatedAverage[i] = interpolate(statistics.churnCreatedAverage[i], real(c), 0.05);
+			statistics.churnDestroyedAverage[i] = interpolate(statistics.churnDestroyedAverage[i], real(d), 0.05);
+		}
+	}
+
+	class Callbacks
+	{
+		EventListener<void()> engineInitListener;
+		EventListener<void()> engineUpdateListener;
+	public:
+		Callbacks() : engineInitListener("churn"), engineUpdateListener("churn")
+		{
+			engineInitListener.attach(controlThread().initialize, -40); // after components are defined
+			engineInitListener.bind<&engineInit>();
+			engineUpdateListener.attach(controlThread().update, -59); // after statistics
+			engineUpdateListener.bind<&engineUpdate>();
+		}
+	} callbacksInstance;
+}
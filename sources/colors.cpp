@@ -0,0 +1,81 @@
+#include "game.h"
+
+namespace
+{
+	constexpr uint32 HueSteps = 6 * 256; // multiple of 6 makes the interpolated table exact
+	constexpr uint32 JitterSteps = 256;
+
+	vec3 hueTable[HueSteps + 1]; // fully saturated colors at full value
+	vec3 jitterTable[JitterSteps]; // offsets applied in hsv space by colorVariation
+
+	void engineInit()
+	{
+		for (uint32 i = 0; i <= HueSteps; i++)
+		{
+			const real h6 = real(i) / HueSteps * 6;
+			hueTable[i] = clamp(vec3(abs(h6 - 3) - 1, 2 - abs(h6 - 2), 2 - abs(h6 - 4)), 0, 1);
+		}
+		for (vec3 &it : jitterTable)
+			it = randomChance3() * 0.1 - 0.05;
+	}
+
+	vec3 pureHue(real hue)
+	{
+		const real f = hue * HueSteps;
+		const uint32 i = min(numeric_cast<uint32>(f), HueSteps - 1);
+		return interpolate(hueTable[i], hueTable[i + 1], f - i);
+	}
+
+	vec3 rgbToHsv(const vec3 &rgb)
+	{
+		const real mx = max(rgb[0], max(rgb[1], rgb[2]));
+		const real mn = min(rgb[0], min(rgb[1], rgb[2]));
+		const real d = mx - mn;
+		real h;
+		if (d > 1e-7)
+		{
+			if (mx == rgb[0])
+				h = (rgb[1] - rgb[2]) / d;
+			else if (mx == rgb[1])
+				h = (rgb[2] - rgb[0]) / d + 2;
+			else
+				h = (rgb[0] - rgb[1]) / d + 4;
+			h /= 6;
+			if (h < 0)
+				h += 1;
+		}
+		return vec3(h, mx > 1e-7 ? d / mx : 0, mx);
+	}
+
+	class Callbacks
+	{
+		EventListener<void()> engineInitListener;
+	public:
+		Callbacks() : engineInitListener("colors")
+		{
+			engineInitListener.attach(controlThread().initialize, -50);
+			engineInitListener.bind<&engineInit>();
+		}
+	} callbacksInstance;
+}
+
+vec3 colorFromHsv(const vec3 &hsv)
+{
+	const real h = hsv[0] - floor(hsv[0]);
+	return hsv[2] * ((1 - hsv[1]) + hsv[1] * pureHue(h));
+}
+
+void colorsFromHsv(PointerRange<vec3> colors)
+{
+	for (vec3 &c : colors)
+		c = colorFromHsv(c);
+}
+
+vec3 colorVariation(const vec3 &color, real hueShift)
+{
+	vec3 hsv = rgbToHsv(color) + jitterTable[randomRange(0u, JitterSteps)];
+	hsv[0] = hsv[0] + hueShift;
+	hsv[1] = saturate(hsv[1]);
+	hsv[2] = saturate(hsv[2]);
+	return colorFromHsv(hsv);
+}
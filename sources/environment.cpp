@@ -4,7 +4,7 @@
 #include <cage-core/config.h>
 #include <cage-core/spatialStructure.h>
 #include <cage-core/hashString.h>
-#include <cage-core/color.h>
+#include <cage-core/macros.h>
 
 #include "game.h"
 
@@ -17,21 +17,70 @@ namespace
 	{
 		static EntityComponent *component;
 
+		uint32 stage = m; // m = common sky-box (menu, hurt)
 		bool dissipating = false;
 	};
 
 	EntityComponent *SkyboxComponent::component;
 
+	// each stage pack contains the stage sky-box and the portal leading to it
+	constexpr uint32 SkyboxStages = BossesTotalCount + 1;
+	constexpr const uint32 SkyboxStagePacks[] = {
+		#define GCHL_GENERATE(N) HashString("degrid/environment/skyboxes/stage" CAGE_STRINGIZE(N) ".pack"),
+				CAGE_EVAL_SMALL(CAGE_EXPAND_ARGS(GCHL_GENERATE, 0, 1, 2, 3, 4, 5))
+		#undef GCHL_GENERATE
+	};
+	constexpr const uint32 SkyboxStageObjects[] = {
+		#define GCHL_GENERATE(N) HashString("degrid/environment/skyboxes/skybox.obj;" CAGE_STRINGIZE(N)),
+				CAGE_EVAL_SMALL(CAGE_EXPAND_ARGS(GCHL_GENERATE, 0, 1, 2, 3, 4, 5))
+		#undef GCHL_GENERATE
+	};
+	static_assert(sizeof(SkyboxStagePacks) / sizeof(SkyboxStagePacks[0]) == SkyboxStages, "sky-box stages count mismatch");
+
+	bool skyboxStageLoaded[SkyboxStages];
+	uint32 skyboxCurrentStage = 0;
+
+	void skyboxStageLoad(uint32 stage)
+	{
+		if (stage >= SkyboxStages || skyboxStageLoaded[stage])
+			return;
+		engineAssets()->add(SkyboxStagePacks[stage]);
+		skyboxStageLoaded[stage] = true;
+	}
+
+	void skyboxStageRelease(uint32 stage)
+	{
+		// the first stage is needed on every game start
+		if (stage == 0 || stage >= SkyboxStages || !skyboxStageLoaded[stage])
+			return;
+		if (stage == skyboxCurrentStage || stage == skyboxCurrentStage + 1)
+			return;
+		engineAssets()->remove(SkyboxStagePacks[stage]);
+		skyboxStageLoaded[stage] = false;
+	}
+
 	void engineInit()
 	{
 		SkyboxComponent::component = engineEntities()->defineComponent(SkyboxComponent());
+		DEGRID_MEMORY_COMPONENT(Skybox);
 		skyboxOrientation = randomDirectionQuat();
 		skyboxRotation = interpolate(quat(), randomDirectionQuat(), 5e-5);
+		skyboxStageLoad(0);
+	}
+
+	void engineFinalize()
+	{
+		for (uint32 i = 0; i < SkyboxStages; i++)
+		{
+			if (skyboxStageLoaded[i])
+				engineAssets()->remove(SkyboxStagePacks[i]);
+			skyboxStageLoaded[i] = false;
+		}
 	}
 
 	void engineUpdate()
 	{
-		OPTICK_EVENT("environment");
+		DEGRID_SYSTEM_TIMING("environment");
 
 		{ // update skybox
 			skyboxOrientation = skyboxRotation * skyboxOrientation;
@@ -47,7 +96,10 @@ namespace
 					CAGE_ASSERT(r.opacity.valid());
 					r.opacity -= 0.05;
 					if (r.opacity < 1e-5)
+					{
 						e->add(entitiesToDestroy);
+						skyboxStageRelease(s.stage);
+					}
 				}
 			}
 
@@ -66,22 +118,6 @@ namespace
 				}
 			}
 		}
-
-		if (game.gameOver || game.paused)
-			return;
-
-		{ // update degrid markers
-			for (Entity *e : GridComponent::component->entities())
-			{
-				CAGE_COMPONENT_ENGINE(Transform, t, e);
-				CAGE_COMPONENT_ENGINE(Render, r, e);
-				DEGRID_COMPONENT(Velocity, v, e);
-				DEGRID_COMPONENT(Grid, g, e);
-				v.velocity *= 0.95;
-				v.velocity += (g.place - t.position) * 0.005;
-				r.color = interpolate(r.color, g.originalColor, 0.002);
-			}
-		}
 	}
 
 	void gameStart()
@@ -93,6 +129,14 @@ namespace
 			e->remove(entitiesToDestroy);
 		}
 
+		// stages of previous game, including those prefetched but never shown
+		for (uint32 i = 1; i < SkyboxStages; i++)
+		{
+			if (skyboxStageLoaded[i])
+				engineAssets()->remove(SkyboxStagePacks[i]);
+			skyboxStageLoaded[i] = false;
+		}
+
 		if (game.cinematic)
 			setSkybox(HashString("degrid/environment/skyboxes/skybox.obj;menu"));
 		else
@@ -107,67 +151,21 @@ namespace
 			l.color = vec3(1);
 			l.intensity = 3;
 		}
-
-		constexpr float radius = MapNoPullRadius + PlayerScale;
-#ifdef CAGE_DEBUG
-		constexpr float step = 50;
-#else
-		constexpr float step = 12;
-#endif
-		for (real y = -radius; y < radius + 1e-3; y += step)
-		{
-			for (real x = -radius; x < radius + 1e-3; x += step)
-			{
-				const real d = length(vec3(x, 0, y));
-				if (d > radius || d < 1e-7)
-					continue;
-				Entity *e = engineEntities()->createUnique();
-				DEGRID_COMPONENT(Velocity, velocity, e);
-				velocity.velocity = randomDirection3();
-				DEGRID_COMPONENT(Grid, grid, e);
-				grid.place = vec3(x, -2, y) + vec3(randomChance(), randomChance() * 0.1, randomChance()) * 2 - 1;
-				CAGE_COMPONENT_ENGINE(Transform, transform, e);
-				transform.scale = 0.7;
-				transform.position = grid.place + randomDirection3() * vec3(10, 0.1, 10);
-				CAGE_COMPONENT_ENGINE(Render, render, e);
-				render.object = HashString("degrid/environment/grid.object");
-				real ang = real(atan2(x, y)) / (real::Pi() * 2) + 0.5;
-				real dst = d / radius;
-				render.color = colorHsvToRgb(vec3(ang, 1, interpolate(real(0.6), real(0.4), sqr(dst))));
-				grid.originalColor = render.color;
-			}
-		}
-
-#ifdef CAGE_DEBUG
-		constexpr float angStep = 9;
-#else
-		constexpr float angStep = 3;
-#endif
-		for (rads ang = degs(0); ang < degs(360); ang += degs(angStep))
-		{
-			Entity *e = engineEntities()->createUnique();
-			DEGRID_COMPONENT(Grid, grid, e);
-			CAGE_COMPONENT_ENGINE(Transform, transform, e);
-			transform.position = grid.place = vec3(sin(ang), 0, cos(ang)) * (radius + step * 0.5);
-			transform.scale = 0.6;
-			CAGE_COMPONENT_ENGINE(Render, render, e);
-			render.object = HashString("degrid/environment/grid.object");
-			grid.originalColor = render.color = vec3(1);
-		}
-
-		statistics.environmentGridMarkers = GridComponent::component->group()->count();
 	}
 
 	class Callbacks
 	{
 		EventListener<void()> engineInitListener;
+		EventListener<void()> engineFinalizeListener;
 		EventListener<void()> engineUpdateListener;
 		EventListener<void()> gameStartListener;
 	public:
-		Callbacks() : engineInitListener("environment"), engineUpdateListener("environment"), gameStartListener("environment")
+		Callbacks() : engineInitListener("environment"), engineFinalizeListener("environment"), engineUpdateListener("environment"), gameStartListener("environment")
 		{
 			engineInitListener.attach(controlThread().initialize, -35);
 			engineInitListener.bind<&engineInit>();
+			engineFinalizeListener.attach(controlThread().finalize);
+			engineFinalizeListener.bind<&engineFinalize>();
 			engineUpdateListener.attach(controlThread().update, 5);
 			engineUpdateListener.bind<&engineUpdate>();
 			gameStartListener.attach(gameStartEvent(), -5);
@@ -178,6 +176,14 @@ namespace
 
 void setSkybox(uint32 objectName)
 {
+	uint32 stage = m;
+	for (uint32 i = 0; i < SkyboxStages; i++)
+		if (SkyboxStageObjects[i] == objectName)
+			stage = i;
+	if (stage != m)
+		skyboxStageLoad(stage);
+	skyboxCurrentStage = stage == m ? 0 : stage;
+
 	{ // initiate disappearing of old sky-boxes
 		for (Entity *e : SkyboxComponent::component->entities())
 		{
@@ -197,56 +203,33 @@ void setSkybox(uint32 objectName)
 		r.object = objectName;
 		r.opacity = 1;
 		DEGRID_COMPONENT(Skybox, s, e);
+		s.stage = stage;
 	}
 }
 
+void skyboxesPrefetch(uint32 stage)
+{
+	skyboxStageLoad(stage);
+	skyboxStageLoad(stage + 1);
+}
+
 void environmentExplosion(const vec3 &position, const vec3 &velocity, const vec3 &color, real size)
 {
 	statistics.environmentExplosions++;
 
 	// colorize nearby grids
-	spatialSearchQuery->intersection(Sphere(position, size * 2));
-	for (uint32 otherName : spatialSearchQuery->result())
-	{
-		if (!engineEntities()->has(otherName))
-			continue;
-		Entity *e = engineEntities()->get(otherName);
-		if (!e->has(GridComponent::component))
-			continue;
-		CAGE_COMPONENT_ENGINE(Transform, ot, e);
-		CAGE_COMPONENT_ENGINE(Render, orc, e);
-		DEGRID_COMPONENT(Velocity, og, e);
-		vec3 toOther = ot.position - position;
-		real dist = length(toOther);
-		real intpr = smoothstep(((size - dist) / size + 1) * 0.5);
-		vec3 dir = normalize(toOther);
-		vec3 change = dir * intpr;
-		og.velocity += change;
-		ot.position += change * 2;
-		orc.color = interpolate(color, orc.color, intpr);
-	}
+	gridExplosion(position, color, size);
 
 	// create some debris
-	uint32 cnt = numeric_cast<uint32>(size * size * 0.5 + 2);
+	uint32 cnt = numeric_cast<uint32>((size * size * 0.5 + 2) * qualityScale() + 0.5);
 	for (uint32 i = 0; i < cnt; i++)
 	{
 		real scale = randomChance();
-		Entity *e = engineEntities()->createAnonymous();
-		DEGRID_COMPONENT(Timeout, timeout, e);
-		timeout.ttl = randomRange(5, 25);
-		DEGRID_COMPONENT(Velocity, vel, e);
-		vel.velocity = velocity * 0.5 + randomDirection3() * (1.1 - scale);
-		CAGE_COMPONENT_ENGINE(Transform, transform, e);
-		transform.scale = randomRange(1.0, 1.3) * (scale * 0.4 + 0.8);
-		transform.position = position + randomDirection3() * (randomChance() * size);
-		transform.orientation = randomDirectionQuat();
-		CAGE_COMPONENT_ENGINE(Render, render, e);
-		render.object = HashString("degrid/environment/explosion.object");
-		render.color = colorVariation(color);
-		e->add(entitiesPhysicsEvenWhenPaused);
+		particleDebris(position + randomDirection3() * (randomChance() * size), velocity * 0.5 + randomDirection3() * (1.1 - scale), randomRange(1.0, 1.3) * (scale * 0.4 + 0.8), colorVariation(color), randomRange(5, 25));
 	}
 
 	// create light
+	if (randomChance() < qualityScale())
 	{
 		Entity *e = engineEntities()->createAnonymous();
 		DEGRID_COMPONENT(Timeout, timeout, e);
@@ -257,14 +240,11 @@ void environmentExplosion(const vec3 &position, const vec3 &velocity, const vec3
 		transform.position = position + randomDirection3() * vec3(1, 0.1, 1) * size * randomChance();
 		transform.position[1] = abs(transform.position[1]); // make the light always above the game plane (closer to camera)
 		e->add(entitiesPhysicsEvenWhenPaused);
-		CAGE_COMPONENT_ENGINE(Light, light, e);
-		vec3 colorinv = colorRgbToHsv(color);
-		colorinv[0] = (colorinv[0] + 0.5) % 1;
-		colorinv = colorHsvToRgb(colorinv);
-		light.color = colorVariation(colorinv);
+		DEGRID_COMPONENT(LightSource, light, e);
+		light.color = colorVariation(color, 0.5); // opposite hue
 		light.intensity = randomRange(0.8, 1.2);
-		light.lightType = LightTypeEnum::Point;
 		light.attenuation = vec3(0, 0, 0.005);
+		light.priority = 1;
 
 		//CAGE_COMPONENT_ENGINE(Render, render, e);
 		//render.object = HashString("cage/mesh/fake.obj");
@@ -287,11 +267,3 @@ void shotExplosion(Entity *e)
 	DEGRID_COMPONENT(Velocity, v, e);
 	environmentExplosion(t.position, v.velocity, r.color, t.scale);
 }
-
-vec3 colorVariation(const vec3 &color)
-{
-	vec3 dev = randomChance3() * 0.1 - 0.05;
-	vec3 hsv = colorRgbToHsv(color) + dev;
-	hsv[0] = (hsv[0] + 1) % 1;
-	return colorHsvToRgb(clamp(hsv, 0, 1));
-}
@@ -9,6 +9,15 @@
 
 using namespace cage;
 
+enum class SoundPriorityEnum : uint32
+{
+	// less important voices are stolen first
+	Debris,
+	Monster,
+	Pickup,
+	Boss,
+};
+
 bool collisionTest(const vec3 &positionA, real radiusA, const vec3 &velocityA, const vec3 &positionB, real radiusB, const vec3 &velocityB);
 void powerupSpawn(const vec3 &position);
 void monstersSpawnInitial();
@@ -17,19 +26,54 @@ void environmentExplosion(const vec3 &position, const vec3 &velocity, const vec3
 void monsterExplosion(Entity *e);
 void shotExplosion(Entity *e);
 bool killMonster(Entity *e, bool allowCallback);
-void soundEffect(uint32 sound, const vec3 &position);
-void soundSpeech(uint32 sound);
-void soundSpeech(const uint32 sounds[]);
+void soundEffect(uint32 sound, const vec3 &position, SoundPriorityEnum priority = SoundPriorityEnum::Debris);
 void setSkybox(uint32 objectName);
+uint32 qualityLevel(); // 0 = full cosmetic quality, higher levels reduce cosmetic effects
+real qualityScale(); // fraction of cosmetic effects to keep at current quality level
+real mapNoPullRadius(); // arena size, configurable through degrid/map/radius
+void skyboxesPrefetch(uint32 stage); // start loading sky-boxes (and portals) of the stage and the following one
 bool achievementFullfilled(const string &name, bool bossKill = false); // returns if this is the first time the achievement is fulfilled
 void makeAnnouncement(uint32 headline, uint32 description, uint32 duration = 30 * 30);
 uint32 permanentPowerupLimit();
 uint32 currentPermanentPowerups();
 bool canAddPermanentPowerup();
-vec3 colorVariation(const vec3 &color);
+vec3 colorVariation(const vec3 &color, real hueShift = 0); // small random deviation of the color
+vec3 colorFromHsv(const vec3 &hsv); // table based conversion
+void colorsFromHsv(PointerRange<vec3> colors); // in-place batch conversion
+PointerRange<const uint32> gridMarkersQuery(const vec3 &center, real radius); // indices of grid markers near the center; valid until next query
+vec3 gridMarkerPosition(uint32 index);
+vec3 gridMarkerColor(uint32 index);
+void gridMarkerColor(uint32 index, const vec3 &color);
+void gridMarkerImpulse(uint32 index, const vec3 &velocityChange, const vec3 &positionChange);
+void gridMarkerTeleport(uint32 index, const vec3 &position);
+void gridMarkersScatter(const vec3 &center, const vec3 &extent);
+void gridExplosion(const vec3 &position, const vec3 &color, real size); // applied to the markers in the next grid update
 EventDispatcher<bool()> &gameStartEvent();
 EventDispatcher<bool()> &gameStopEvent();
 
+enum class ParticleEmitterEnum
+{
+	Explosion,
+	Ship,
+	Rocket,
+	Total
+};
+
+enum class SpeechCategoryEnum
+{
+	// ordered by priority
+	Progress,
+	Pickup, // picking up and using powerups
+	Damage,
+	Game, // start and end of the game
+};
+
+void soundSpeech(uint32 sound, SpeechCategoryEnum category);
+void soundSpeech(const uint32 sounds[], SpeechCategoryEnum category); // zero terminated, picks one randomly
+
+void particleDebris(const vec3 &position, const vec3 &velocity, real scale, const vec3 &color, uint32 ttl);
+void particleSpark(ParticleEmitterEnum emitter, const vec3 &position, const vec3 &velocity, real scale, uint32 ttl);
+
 enum class PowerupTypeEnum
 {
 	// collectibles
@@ -69,7 +113,6 @@ constexpr const float PowerupChances[(uint32)PowerupTypeEnum::Total] = {
 };
 constexpr const char Letters[] = { 'C', 'E', 'F', 'Q', 'R', 'V', 'X', 'Z' };
 constexpr float PlayerScale = 3;
-constexpr float MapNoPullRadius = 250;
 const vec3 PlayerDeathColor = vec3(0.68, 0.578, 0.252);
 constexpr uint32 ShotsTtl = 300;
 constexpr uint32 BossesTotalCount = 5;
@@ -83,6 +126,19 @@ extern EntityGroup *entitiesPhysicsEvenWhenPaused;
 extern Holder<SpatialStructure> spatialSearchData;
 extern Holder<SpatialQuery> spatialSearchQuery;
 
+enum class SpatialSiteEnum : uint32
+{
+	MonstersDispersion,
+	SimpleMonstersAvoidance,
+	ShielderShots,
+	Wormhole,
+	Shots,
+	Total
+};
+
+PointerRange<const uint32> spatialQuery(SpatialSiteEnum site, const Sphere &sphere); // counted intersection with the spatialSearchQuery
+void spatialQueryUsed(SpatialSiteEnum site); // count one result that passed the filter of the site
+
 struct Achievements
 {
 	uint32 bosses = 0;
@@ -90,6 +146,18 @@ struct Achievements
 };
 extern Achievements achievements;
 
+constexpr const float PlayerProximityRadii[] = { 30, 60, 120 };
+constexpr uint32 PlayerProximityRadiiCount = sizeof(PlayerProximityRadii) / sizeof(PlayerProximityRadii[0]);
+
+// summary of monsters around the player, published by the monsters update
+struct PlayerProximity
+{
+	real closestDistance = real::Infinity();
+	uint32 closestMonster = 0; // entity name
+	uint32 within[PlayerProximityRadiiCount] = {}; // number of monsters within each of the radii
+};
+extern PlayerProximity playerProximity;
+
 struct GlobalGame
 {
 	// game state
@@ -121,12 +189,28 @@ struct GlobalGame
 };
 extern GlobalGame game;
 
+enum class ChurnCategoryEnum : uint32
+{
+	Entities, // all entities
+	Monsters,
+	Shots,
+	Powerups,
+	Timeouts,
+	LightSources,
+	Lights,
+	Sounds,
+	Renders,
+	Total
+};
+
 struct GlobalStatistics
 {
 	uint64 timeStart;
 	uint64 timeRenderMin; // minimal render time [us]
 	uint64 timeRenderMax; // maximal render time [us]
 	uint64 timeRenderCurrent; // last frame render time [us]
+	uint64 timeRenderCostCurrent; // last frame prepare and dispatch time, without waiting for vsync [us]
+	uint64 timeUpdateCurrent; // last game update time [us]
 	uint32 shotsFired; // total number of shots fired by player's ship
 	uint32 shotsTurret; // total number of shots fired by turrets
 	uint32 shotsHit; // total number of monsters hit by shots
@@ -154,6 +238,24 @@ struct GlobalStatistics
 	uint32 bombsKillTotal; // total number of monsters killed by all bombs
 	uint32 bombsHitMax; // number of monsters hit by the most hitting bomb
 	uint32 bombsKillMax; // number of monsters killed by the most killing bomb
+	uint32 killsQueued; // total number of monster kills processed through the kill events queue
+	uint32 killExplosionsCoalesced; // explosions merged into another explosion in the same tick
+	uint32 killSoundsCoalesced; // duplicate defeated sounds skipped in the same tick
+	uint32 particlesCurrent;
+	uint32 particlesMax;
+	uint32 particlesDropped; // particles not spawned due to the emitter budget
+	uint32 gridMarkersAwake;
+	uint32 gridMarkersAsleep;
+	uint32 gridChunksActive;
+	uint32 gridChunksActivations;
+	uint32 gridChunksDeactivations;
+	uint32 lightsCurrent;
+	uint32 lightsMax;
+	uint32 lightsMerged; // light requests merged into nearby light of same color
+	uint32 lightsDropped; // light requests over the budget
+	uint32 qualityLevel; // current cosmetic quality level
+	uint32 qualityLevelMax; // the most reduced cosmetic quality level
+	uint32 qualityChanges;
 	uint32 shieldStoppedMonsters; // number of monsters blocked by player's shield
 	real shieldAbsorbedDamage; // total amount of damage absorbed from the blocked monsters
 	uint32 turretsPlaced;
@@ -169,10 +271,64 @@ struct GlobalStatistics
 	uint32 frameIteration; // number of rendered frames
 	uint32 soundEffectsCurrent;
 	uint32 soundEffectsMax;
+	uint32 soundEffectsDropped; // effects not played due to the voices budget, concurrency limit or distance
+	uint32 soundEffectsStolen; // playing effects replaced by more important ones
+	uint32 soundVoicesCurrent; // effects playing from the voices pool
+	uint32 speechPlayed;
+	uint32 speechCoalesced; // requests merged with a pending line of same category or same sound
+	uint32 speechDropped; // requests rejected by full queue
+	uint32 speechReplaced; // queued lines displaced by more important requests
+	uint32 speechExpired; // requests waiting in the queue for too long
+	uint32 spatialItemsCurrent; // in the spatial structure
+	uint32 spatialQueries[(uint32)SpatialSiteEnum::Total];
+	uint32 spatialResults[(uint32)SpatialSiteEnum::Total]; // returned by the queries
+	uint32 spatialUsed[(uint32)SpatialSiteEnum::Total]; // results that passed the filters
+	uint32 spatialQueriesCurrent[(uint32)SpatialSiteEnum::Total]; // in current tick
+	uint32 spatialResultsCurrent[(uint32)SpatialSiteEnum::Total];
+	uint32 spatialUsedCurrent[(uint32)SpatialSiteEnum::Total];
+	// entities (or components for the categories) added and removed
+	uint32 churnCreated[(uint32)ChurnCategoryEnum::Total];
+	uint32 churnDestroyed[(uint32)ChurnCategoryEnum::Total];
+	uint32 churnCreatedCurrent[(uint32)ChurnCategoryEnum::Total]; // in previous tick
+	uint32 churnDestroyedCurrent[(uint32)ChurnCategoryEnum::Total];
+	uint32 churnCreatedPeak[(uint32)ChurnCategoryEnum::Total]; // most in single tick
+	uint32 churnDestroyedPeak[(uint32)ChurnCategoryEnum::Total];
+	real churnCreatedAverage[(uint32)ChurnCategoryEnum::Total]; // exponential moving average per tick
+	real churnDestroyedAverage[(uint32)ChurnCategoryEnum::Total];
 
 	GlobalStatistics();
 };
 extern GlobalStatistics statistics;
+Ini *gameReport(); // report of current game, written at game stop, may be null
+
+// durations of the systems updates in the control thread
+struct SystemTiming;
+struct SystemTimingPercentiles
+{
+	uint64 p50 = 0, p95 = 0, p99 = 0, max = 0; // us
+	uint32 samples = 0;
+};
+SystemTiming *systemTimingFind(const char *name); // registers the system on first use
+void systemTimingRecord(SystemTiming *timing, uint64 duration);
+uint32 systemTimingCount();
+const char *systemTimingName(uint32 index);
+SystemTimingPercentiles systemTimingPercentiles(uint32 index); // over the recent ticks
+
+struct SystemTimingScope
+{
+	SystemTiming *const timing;
+	const uint64 start;
+	explicit SystemTimingScope(SystemTiming *timing) : timing(timing), start(applicationTime()) {}
+	~SystemTimingScope() { systemTimingRecord(timing, applicationTime() - start); }
+};
+
+#define DEGRID_SYSTEM_TIMING(NAME) OPTICK_EVENT(NAME); static SystemTiming *const systemTimingInstance = systemTimingFind(NAME); const SystemTimingScope systemTimingScope(systemTimingInstance)
+
+// estimated memory usage
+void memoryComponent(const char *name, EntityComponent *component, uint32 size); // registers the component for the memory report
+void memoryReport(); // logs the memory report and adds it to the game report
+
+#define DEGRID_MEMORY_COMPONENT(T) memoryComponent(#T, ::T##Component::component, sizeof(::T##Component))
 
 // components
 
@@ -200,11 +356,13 @@ struct TimeoutComponent
 	uint32 ttl = 0; // game updates (does not tick when paused)
 };
 
-struct GridComponent
+struct LightSourceComponent
 {
 	static EntityComponent *component;
-	vec3 place;
-	vec3 originalColor;
+	vec3 color = vec3(1);
+	vec3 attenuation = vec3(0, 0, 0.005);
+	real intensity = 1;
+	uint32 priority = 0; // lights with higher priority are kept when over the budget
 };
 
 struct ShotComponent
@@ -228,6 +386,7 @@ struct MonsterComponent
 	real groundLevel;
 	real dispersion;
 	uint32 defeatedSound = 0;
+	SoundPriorityEnum defeatedSoundPriority = SoundPriorityEnum::Debris;
 	Delegate<void(uint32)> defeatedCallback;
 };
 
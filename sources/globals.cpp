@@ -1,4 +1,5 @@
 #include <cage-core/entities.h>
+#include <cage-core/config.h>
 
 #include "game.h"
 
@@ -6,12 +7,22 @@ EntityComponent *GravityComponent::component;
 EntityComponent *VelocityComponent::component;
 EntityComponent *RotationComponent::component;
 EntityComponent *TimeoutComponent::component;
-EntityComponent *GridComponent::component;
+EntityComponent *LightSourceComponent::component;
 EntityComponent *ShotComponent::component;
 EntityComponent *PowerupComponent::component;
 EntityComponent *MonsterComponent::component;
 EntityComponent *BossComponent::component;
 
+namespace
+{
+	ConfigFloat confMapRadius("degrid/map/radius", 250);
+}
+
+real mapNoPullRadius()
+{
+	return max(real(confMapRadius), real(50));
+}
+
 EventDispatcher<bool()> &gameStartEvent()
 {
 	static EventDispatcher<bool()> inst;
@@ -29,14 +40,23 @@ namespace
 	void engineInit()
 	{
 		GravityComponent::component = engineEntities()->defineComponent(GravityComponent());
+		DEGRID_MEMORY_COMPONENT(Gravity);
 		VelocityComponent::component = engineEntities()->defineComponent(VelocityComponent());
+		DEGRID_MEMORY_COMPONENT(Velocity);
 		RotationComponent::component = engineEntities()->defineComponent(RotationComponent());
+		DEGRID_MEMORY_COMPONENT(Rotation);
 		TimeoutComponent::component = engineEntities()->defineComponent(TimeoutComponent());
-		GridComponent::component = engineEntities()->defineComponent(GridComponent());
+		DEGRID_MEMORY_COMPONENT(Timeout);
+		LightSourceComponent::component = engineEntities()->defineComponent(LightSourceComponent());
+		DEGRID_MEMORY_COMPONENT(LightSource);
 		ShotComponent::component = engineEntities()->defineComponent(ShotComponent());
+		DEGRID_MEMORY_COMPONENT(Shot);
 		PowerupComponent::component = engineEntities()->defineComponent(PowerupComponent());
+		DEGRID_MEMORY_COMPONENT(Powerup);
 		MonsterComponent::component = engineEntities()->defineComponent(MonsterComponent());
+		DEGRID_MEMORY_COMPONENT(Monster);
 		BossComponent::component = engineEntities()->defineComponent(BossComponent());
+		DEGRID_MEMORY_COMPONENT(Boss);
 	}
 
 	class Callbacks
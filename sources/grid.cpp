@@ -0,0 +1,778 @@
+#include <cage-core/entities.h>
+#include <cage-core/hashString.h>
+#include <cage-core/config.h>
+
+#include "game.h"
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+Entity *getPrimaryCameraEntity();
+
+namespace
+{
+	ConfigFloat confGridDensity("degrid/grid/density", 1);
+	ConfigFloat confGridActivationRadius("degrid/grid/activationRadius", 300);
+
+	std::vector<uint32> queryResult;
+
+#ifdef CAGE_DEBUG
+	constexpr float GridBaseStep = 50;
+	constexpr float GridBaseAngStep = 9;
+#else
+	constexpr float GridBaseStep = 12;
+	constexpr float GridBaseAngStep = 3;
+#endif
+	constexpr float GridChunkSize = 60;
+	constexpr float GridSpring = 0.005f;
+	constexpr float GridDamping = 0.95f;
+	constexpr float GridColorRecovery = 0.002f;
+	constexpr float GridMarkerMaxScale = 0.7f;
+	constexpr float GridRestVelocity = 1e-6f; // squared
+	constexpr float GridRestDistance = 1e-4f; // squared
+	constexpr float GridRestColor = 1e-4f; // squared
+	constexpr float GridGravityWake = 0.01f; // minimal gravity pull that wakes a sleeping marker
+
+	// structure of arrays, one element per marker, markers of each chunk are contiguous
+	struct GridMarkers
+	{
+		std::vector<float> position[3];
+		std::vector<float> velocity[3];
+		std::vector<float> home[3];
+		std::vector<float> color[3];
+		std::vector<float> originalColor[3];
+		std::vector<float> scale;
+		std::vector<Entity *> entities; // nullptr when the chunk is not active
+		std::vector<uint32> chunk;
+		std::vector<uint8> awake; // 0 = sleeping at its home place
+		std::vector<uint8> indexed; // 1 = in the dynamic lattice, 0 = in the static lattice
+		std::vector<uint8> visible; // 0 = no render component due to reduced quality
+		std::vector<uint32> awakeList;
+		uint32 count = 0;
+
+		void clear()
+		{
+			for (uint32 a = 0; a < 3; a++)
+			{
+				position[a].clear();
+				velocity[a].clear();
+				home[a].clear();
+				color[a].clear();
+				originalColor[a].clear();
+			}
+			scale.clear();
+			entities.clear();
+			chunk.clear();
+			awake.clear();
+			indexed.clear();
+			visible.clear();
+			awakeList.clear();
+			count = 0;
+		}
+
+		void add(const vec3 &pos, const vec3 &vel, const vec3 &hom, const vec3 &col, real scl, uint32 chk)
+		{
+			for (uint32 a = 0; a < 3; a++)
+			{
+				position[a].push_back(pos[a].value);
+				velocity[a].push_back(vel[a].value);
+				home[a].push_back(hom[a].value);
+				color[a].push_back(col[a].value);
+				originalColor[a].push_back(col[a].value);
+			}
+			scale.push_back(scl.value);
+			entities.push_back(nullptr);
+			chunk.push_back(chk);
+			awake.push_back(0);
+			indexed.push_back(0);
+			visible.push_back(0);
+			count++;
+		}
+
+		void wake(uint32 i)
+		{
+			if (awake[i])
+				return;
+			awake[i] = 1;
+			awakeList.push_back(i);
+		}
+	} markers;
+
+	// awake markers gathered into contiguous arrays, so that the simulation passes run over dense ranges
+	struct GridAwakeMarkers
+	{
+		std::vector<float> position[3];
+		std::vector<float> velocity[3];
+		std::vector<float> home[3];
+		std::vector<float> color[3];
+		std::vector<float> originalColor[3];
+
+		void gather(const std::vector<uint32> &list)
+		{
+			const uint32 n = numeric_cast<uint32>(list.size());
+			for (uint32 a = 0; a < 3; a++)
+			{
+				for (std::vector<float> *v : { &position[a], &velocity[a], &home[a], &color[a], &originalColor[a] })
+					v->resize(n);
+				for (uint32 k = 0; k < n; k++)
+				{
+					const uint32 i = list[k];
+					position[a][k] = markers.position[a][i];
+					velocity[a][k] = markers.velocity[a][i];
+					home[a][k] = markers.home[a][i];
+					color[a][k] = markers.color[a][i];
+					originalColor[a][k] = markers.originalColor[a][i];
+				}
+			}
+		}
+
+		void scatter(const std::vector<uint32> &list) const
+		{
+			const uint32 n = numeric_cast<uint32>(list.size());
+			for (uint32 a = 0; a < 3; a++)
+			{
+				for (uint32 k = 0; k < n; k++)
+				{
+					const uint32 i = list[k];
+					markers.position[a][i] = position[a][k];
+					markers.velocity[a][i] = velocity[a][k];
+					markers.color[a][i] = color[a][k];
+				}
+			}
+		}
+	} awakeMarkers;
+
+	struct GridChunk
+	{
+		vec3 center;
+		uint32 begin = 0;
+		uint32 end = 0;
+		bool active = false;
+	};
+
+	std::vector<GridChunk> chunks;
+	uint32 chunksSide = 0;
+	float builtDensity = 0; // density the grid was built with
+	float builtRadius = 0; // arena radius the grid was built for
+	bool built = false;
+	uint32 densityLevel = m;
+
+	uint32 chunkCoord(real v)
+	{
+		const sint32 c = (sint32)std::floor((v.value + builtRadius + GridChunkSize) / GridChunkSize);
+		return (uint32)std::min(std::max(c, 0), (sint32)chunksSide - 1);
+	}
+
+	// markers bucketed into square cells in compressed rows
+	struct GridLattice
+	{
+		std::vector<uint32> cellStart; // side * side + 1 offsets into cellMarkers
+		std::vector<uint32> cellMarkers;
+		std::vector<uint32> cursor;
+		float origin = 0;
+		float step = 1;
+		uint32 side = 0;
+
+		uint32 coord(float v) const
+		{
+			const sint32 c = (sint32)std::floor((v - origin) / step);
+			return (uint32)std::min(std::max(c, 0), (sint32)side - 1);
+		}
+
+		void rebuild(const float *px, const float *pz, const std::vector<uint32> &indices)
+		{
+			cellStart.assign(side * side + 1, 0);
+			cellMarkers.resize(indices.size());
+			for (uint32 i : indices)
+				cellStart[coord(pz[i]) * side + coord(px[i]) + 1]++;
+			for (uint32 c = 0; c < side * side; c++)
+				cellStart[c + 1] += cellStart[c];
+			cursor.assign(cellStart.begin(), cellStart.end() - 1);
+			for (uint32 i : indices)
+				cellMarkers[cursor[coord(pz[i]) * side + coord(px[i])]++] = i;
+		}
+
+		template<bool Static>
+		void query(float cx, float cy, float cz, float r)
+		{
+			if (side == 0)
+				return;
+			const uint32 x0 = coord(cx - r - GridMarkerMaxScale), x1 = coord(cx + r + GridMarkerMaxScale);
+			const uint32 z0 = coord(cz - r - GridMarkerMaxScale), z1 = coord(cz + r + GridMarkerMaxScale);
+			for (uint32 z = z0; z <= z1; z++)
+			{
+				for (uint32 x = x0; x <= x1; x++)
+				{
+					const uint32 c = z * side + x;
+					for (uint32 k = cellStart[c]; k < cellStart[c + 1]; k++)
+					{
+						const uint32 i = cellMarkers[k];
+						if (Static && (markers.indexed[i] || !chunks[markers.chunk[i]].active))
+							continue;
+						const float dx = markers.position[0][i] - cx, dy = markers.position[1][i] - cy, dz = markers.position[2][i] - cz;
+						const float rr = r + markers.scale[i];
+						if (dx * dx + dy * dy + dz * dz <= rr * rr)
+							queryResult.push_back(i);
+					}
+				}
+			}
+		}
+	};
+
+	GridLattice staticLattice; // all markers by their home places, used for the sleeping ones
+	GridLattice dynamicLattice; // awake markers by their current positions
+	std::vector<uint32> allMarkers;
+
+	struct GridExplosion
+	{
+		vec3 position;
+		vec3 color;
+		real size;
+	};
+
+	std::vector<GridExplosion> explosions; // recorded during the tick
+	std::vector<uint32> explosionsCellStart; // explosions binned into the lattice cells they reach
+	std::vector<uint32> explosionsCellItems;
+	std::vector<uint32> explosionsCursor;
+
+	bool markerVisible(uint32 i)
+	{
+		const uint32 threshold = numeric_cast<uint32>(qualityScale() * 1024);
+		return ((i * 2654435761u) >> 10) % 1024 < threshold;
+	}
+
+	void markerShow(uint32 i)
+	{
+		Entity *e = markers.entities[i];
+		CAGE_COMPONENT_ENGINE(Transform, t, e);
+		t.position = vec3(markers.position[0][i], markers.position[1][i], markers.position[2][i]);
+		e->remove(TransformComponent::componentHistory);
+		CAGE_COMPONENT_ENGINE(Render, r, e);
+		r.object = HashString("degrid/environment/grid.object");
+		r.color = vec3(markers.color[0][i], markers.color[1][i], markers.color[2][i]);
+	}
+
+	float configuredDensity()
+	{
+		return std::max((float)confGridDensity, 0.1f);
+	}
+
+	float configuredRadius()
+	{
+		return (mapNoPullRadius() + PlayerScale).value;
+	}
+
+	void build()
+	{
+		markers.clear();
+		chunks.clear();
+
+		built = true;
+		builtDensity = configuredDensity();
+		builtRadius = configuredRadius();
+		const float step = GridBaseStep / builtDensity;
+		const float angStep = GridBaseAngStep / builtDensity;
+
+		chunksSide = numeric_cast<uint32>(std::ceil(2 * (builtRadius + GridChunkSize) / GridChunkSize));
+		chunks.resize(chunksSide * chunksSide);
+		for (uint32 y = 0; y < chunksSide; y++)
+			for (uint32 x = 0; x < chunksSide; x++)
+				chunks[y * chunksSide + x].center = (vec3(x, 0, y) + 0.5) * GridChunkSize - vec3(1, 0, 1) * (builtRadius + GridChunkSize);
+
+		struct Candidate
+		{
+			vec3 home;
+			vec3 color;
+			real scale;
+			bool ring = false;
+		};
+		std::vector<Candidate> candidates;
+
+		for (real y = -builtRadius; y < builtRadius + 1e-3; y += step)
+		{
+			for (real x = -builtRadius; x < builtRadius + 1e-3; x += step)
+			{
+				const real d = length(vec3(x, 0, y));
+				if (d > builtRadius || d < 1e-7)
+					continue;
+				Candidate c;
+				c.home = vec3(x, -2, y) + vec3(randomChance(), randomChance() * 0.1, randomChance()) * 2 - 1;
+				const real ang = real(atan2(x, y)) / (real::Pi() * 2) + 0.5;
+				const real dst = d / builtRadius;
+				c.color = colorFromHsv(vec3(ang, 1, interpolate(real(0.6), real(0.4), sqr(dst))));
+				c.scale = 0.7;
+				candidates.push_back(c);
+			}
+		}
+
+		for (rads ang = degs(0); ang < degs(360); ang += degs(angStep))
+		{
+			Candidate c;
+			c.home = vec3(sin(ang), 0, cos(ang)) * (builtRadius + step * 0.5);
+			c.color = vec3(1);
+			c.scale = 0.6;
+			c.ring = true;
+			candidates.push_back(c);
+		}
+
+		// group the markers by chunks
+		std::vector<std::vector<uint32>> byChunk(chunks.size());
+		for (uint32 i = 0; i < candidates.size(); i++)
+			byChunk[chunkCoord(candidates[i].home[2]) * chunksSide + chunkCoord(candidates[i].home[0])].push_back(i);
+		for (uint32 ci = 0; ci < chunks.size(); ci++)
+		{
+			chunks[ci].begin = markers.count;
+			for (uint32 i : byChunk[ci])
+			{
+				const Candidate &c = candidates[i];
+				if (c.ring)
+					markers.add(c.home, vec3(), c.home, c.color, c.scale, ci);
+				else
+					markers.add(c.home + randomDirection3() * vec3(10, 0.1, 10), randomDirection3(), c.home, c.color, c.scale, ci);
+			}
+			chunks[ci].end = markers.count;
+		}
+
+		const float extent = builtRadius + step;
+		for (GridLattice *l : { &staticLattice, &dynamicLattice })
+		{
+			l->origin = -extent;
+			l->step = step;
+			l->side = numeric_cast<uint32>(std::ceil(2 * extent / step));
+		}
+		allMarkers.resize(markers.count);
+		for (uint32 i = 0; i < markers.count; i++)
+			allMarkers[i] = i;
+		staticLattice.rebuild(markers.home[0].data(), markers.home[2].data(), allMarkers);
+		dynamicLattice.rebuild(markers.position[0].data(), markers.position[2].data(), markers.awakeList);
+
+		densityLevel = qualityLevel();
+		statistics.environmentGridMarkers = markers.count;
+	}
+
+	void chunkActivate(GridChunk &c)
+	{
+		c.active = true;
+		for (uint32 i = c.begin; i < c.end; i++)
+		{
+			Entity *e = engineEntities()->createAnonymous();
+			markers.entities[i] = e;
+			CAGE_COMPONENT_ENGINE(Transform, t, e);
+			t.scale = markers.scale[i];
+			markers.visible[i] = markerVisible(i);
+			if (markers.visible[i])
+				markerShow(i);
+			markers.wake(i);
+		}
+		statistics.gridChunksActivations++;
+	}
+
+	void chunkDeactivate(GridChunk &c)
+	{
+		c.active = false;
+		for (uint32 i = c.begin; i < c.end; i++)
+		{
+			markers.entities[i]->add(entitiesToDestroy);
+			markers.entities[i] = nullptr;
+			markers.visible[i] = 0;
+			for (uint32 a = 0; a < 3; a++)
+			{
+				markers.velocity[a][i] = 0;
+				markers.position[a][i] = markers.home[a][i];
+				markers.color[a][i] = markers.originalColor[a][i];
+			}
+			markers.awake[i] = 0; // removed from the list in reindex
+		}
+		statistics.gridChunksDeactivations++;
+	}
+
+	void updateChunks()
+	{
+		vec3 focus[2];
+		uint32 focusCount = 0;
+		if (game.playerEntity)
+		{
+			CAGE_COMPONENT_ENGINE(Transform, t, game.playerEntity);
+			focus[focusCount++] = t.position * vec3(1, 0, 1);
+		}
+		if (Entity *cam = getPrimaryCameraEntity())
+		{
+			CAGE_COMPONENT_ENGINE(Transform, t, cam);
+			focus[focusCount++] = t.position * vec3(1, 0, 1);
+		}
+		const real radius = (real)confGridActivationRadius + GridChunkSize * 0.71;
+		uint32 active = 0;
+		for (GridChunk &c : chunks)
+		{
+			bool want = false;
+			for (uint32 f = 0; f < focusCount; f++)
+				want = want || distanceSquared(c.center, focus[f]) < sqr(radius);
+			if (want && !c.active)
+				chunkActivate(c);
+			else if (!want && c.active)
+				chunkDeactivate(c);
+			active += c.active;
+		}
+		statistics.gridChunksActive = active;
+	}
+
+	void wakeByGravity()
+	{
+		for (Entity *e : GravityComponent::component->entities())
+		{
+			CAGE_COMPONENT_ENGINE(Transform, t, e);
+			DEGRID_COMPONENT(Gravity, g, e);
+			queryResult.clear();
+			const float r = t.scale.value + abs(g.strength).value / GridGravityWake;
+			staticLattice.query<true>(t.position[0].value, t.position[1].value, t.position[2].value, r);
+			for (uint32 i : queryResult)
+				markers.wake(i);
+		}
+	}
+
+	template<bool Static>
+	void applyExplosionsCell(const GridLattice &lattice, uint32 cell)
+	{
+		for (uint32 k = lattice.cellStart[cell]; k < lattice.cellStart[cell + 1]; k++)
+		{
+			const uint32 i = lattice.cellMarkers[k];
+			if ((Static && markers.indexed[i]) || !chunks[markers.chunk[i]].active)
+				continue; // the dynamic lattice may still hold markers of chunks deactivated this tick
+			bool touched = false;
+			vec3 pos = vec3(markers.position[0][i], markers.position[1][i], markers.position[2][i]);
+			vec3 vel = vec3(markers.velocity[0][i], markers.velocity[1][i], markers.velocity[2][i]);
+			vec3 col = vec3(markers.color[0][i], markers.color[1][i], markers.color[2][i]);
+			for (uint32 x = explosionsCellStart[cell]; x < explosionsCellStart[cell + 1]; x++)
+			{
+				const GridExplosion &ex = explosions[explosionsCellItems[x]];
+				const vec3 toOther = pos - ex.position;
+				const real dist = length(toOther);
+				if (dist > ex.size * 2 + markers.scale[i])
+					continue;
+				const real intpr = smoothstep(((ex.size - dist) / ex.size + 1) * 0.5);
+				const vec3 change = normalize(toOther) * intpr;
+				vel += change;
+				pos += change * 2;
+				col = interpolate(ex.color, col, intpr);
+				touched = true;
+			}
+			if (!touched)
+				continue;
+			for (uint32 a = 0; a < 3; a++)
+			{
+				markers.position[a][i] = pos[a].value;
+				markers.velocity[a][i] = vel[a].value;
+				markers.color[a][i] = col[a].value;
+			}
+			markers.wake(i);
+		}
+	}
+
+	void applyExplosions()
+	{
+		if (explosions.empty())
+			return;
+		OPTICK_EVENT("explosions");
+
+		// bin the explosions into the cells
+		const GridLattice &l = staticLattice;
+		const uint32 cells = l.side * l.side;
+		explosionsCellStart.assign(cells + 1, 0);
+		const auto &forCells = [&](const GridExplosion &ex, auto &&fnc) {
+			const float r = (ex.size * 2).value + GridMarkerMaxScale;
+			const uint32 x0 = l.coord(ex.position[0].value - r), x1 = l.coord(ex.position[0].value + r);
+			const uint32 z0 = l.coord(ex.position[2].value - r), z1 = l.coord(ex.position[2].value + r);
+			for (uint32 z = z0; z <= z1; z++)
+				for (uint32 x = x0; x <= x1; x++)
+					fnc(z * l.side + x);
+		};
+		for (const GridExplosion &ex : explosions)
+			forCells(ex, [&](uint32 c) { explosionsCellStart[c + 1]++; });
+		for (uint32 c = 0; c < cells; c++)
+			explosionsCellStart[c + 1] += explosionsCellStart[c];
+		explosionsCellItems.resize(explosionsCellStart[cells]);
+		explosionsCursor.assign(explosionsCellStart.begin(), explosionsCellStart.end() - 1);
+		for (uint32 j = 0; j < explosions.size(); j++)
+			forCells(explosions[j], [&](uint32 c) { explosionsCellItems[explosionsCursor[c]++] = j; });
+
+		// each marker is visited once and receives all explosions of its cell in order
+		for (uint32 c = 0; c < cells; c++)
+		{
+			if (explosionsCellStart[c] == explosionsCellStart[c + 1])
+				continue;
+			applyExplosionsCell<true>(staticLattice, c);
+			applyExplosionsCell<false>(dynamicLattice, c);
+		}
+
+		explosions.clear();
+	}
+
+	void simulate()
+	{
+		const uint32 n = numeric_cast<uint32>(markers.awakeList.size());
+		GridAwakeMarkers &am = awakeMarkers;
+		am.gather(markers.awakeList);
+
+		{ // springs
+			OPTICK_EVENT("springs");
+			for (uint32 a = 0; a < 3; a++)
+			{
+				const float *p = am.position[a].data();
+				float *v = am.velocity[a].data();
+				const float *h = am.home[a].data();
+				for (uint32 k = 0; k < n; k++)
+					v[k] = v[k] * GridDamping + (h[k] - p[k]) * GridSpring;
+			}
+			for (uint32 a = 0; a < 3; a++)
+			{
+				float *c = am.color[a].data();
+				const float *o = am.originalColor[a].data();
+				for (uint32 k = 0; k < n; k++)
+					c[k] += (o[k] - c[k]) * GridColorRecovery;
+			}
+		}
+
+		{ // gravity
+			OPTICK_EVENT("gravity");
+			float *px = am.position[0].data();
+			float *py = am.position[1].data();
+			float *pz = am.position[2].data();
+			for (Entity *e : GravityComponent::component->entities())
+			{
+				CAGE_COMPONENT_ENGINE(Transform, t, e);
+				DEGRID_COMPONENT(Gravity, g, e);
+				const float gx = t.position[0].value, gy = t.position[1].value, gz = t.position[2].value;
+				const float strength = g.strength.value;
+				const float radius = t.scale.value;
+				for (uint32 k = 0; k < n; k++)
+				{
+					const float dx = gx - px[k], dy = gy - py[k], dz = gz - pz[k];
+					const float d2 = dx * dx + dy * dy + dz * dz;
+					const float d = std::sqrt(d2);
+					const float f = d2 < 1e-3f ? 0 : strength / (std::max(d - radius, 1.f) * d);
+					px[k] += dx * f;
+					py[k] += dy * f;
+					pz[k] += dz * f;
+				}
+			}
+		}
+
+		{ // velocity
+			for (uint32 a = 0; a < 3; a++)
+			{
+				float *p = am.position[a].data();
+				const float *v = am.velocity[a].data();
+				for (uint32 k = 0; k < n; k++)
+					p[k] += v[k];
+			}
+		}
+
+		if (GravityComponent::component->group()->count() == 0)
+		{ // rest detection
+			for (uint32 k = 0; k < n; k++)
+			{
+				float vel = 0, dst = 0, col = 0;
+				for (uint32 a = 0; a < 3; a++)
+				{
+					const float v = am.velocity[a][k];
+					const float d = am.position[a][k] - am.home[a][k];
+					const float c = am.color[a][k] - am.originalColor[a][k];
+					vel += v * v;
+					dst += d * d;
+					col += c * c;
+				}
+				if (vel < GridRestVelocity && dst < GridRestDistance && col < GridRestColor)
+				{
+					for (uint32 a = 0; a < 3; a++)
+					{
+						am.velocity[a][k] = 0;
+						am.position[a][k] = am.home[a][k];
+						am.color[a][k] = am.originalColor[a][k];
+					}
+					markers.awake[markers.awakeList[k]] = 0; // removed from the list after synchronization
+				}
+			}
+		}
+
+		am.scatter(markers.awakeList);
+	}
+
+	void applyDensity()
+	{
+		densityLevel = qualityLevel();
+		for (const GridChunk &c : chunks)
+		{
+			if (!c.active)
+				continue;
+			for (uint32 i = c.begin; i < c.end; i++)
+			{
+				const bool vis = markerVisible(i);
+				if (vis == !!markers.visible[i])
+					continue;
+				markers.visible[i] = vis;
+				if (vis)
+					markerShow(i);
+				else
+					markers.entities[i]->remove(RenderComponent::component);
+			}
+		}
+	}
+
+	void synchronize()
+	{
+		OPTICK_EVENT("synchronize");
+		// only the awake markers (and those that have just fallen asleep) have changed
+		for (uint32 i : markers.awakeList)
+		{
+			if (!markers.visible[i])
+				continue;
+			Entity *e = markers.entities[i];
+			CAGE_COMPONENT_ENGINE(Transform, t, e);
+			t.position = vec3(markers.position[0][i], markers.position[1][i], markers.position[2][i]);
+			CAGE_COMPONENT_ENGINE(Render, r, e);
+			r.color = vec3(markers.color[0][i], markers.color[1][i], markers.color[2][i]);
+		}
+	}
+
+	void compactAwake()
+	{
+		std::vector<uint32> &aw = markers.awakeList;
+		for (uint32 i : aw)
+			markers.indexed[i] = markers.awake[i];
+		aw.erase(std::remove_if(aw.begin(), aw.end(), [](uint32 i) { return !markers.awake[i]; }), aw.end());
+	}
+
+	void reindex()
+	{
+		compactAwake();
+		dynamicLattice.rebuild(markers.position[0].data(), markers.position[2].data(), markers.awakeList);
+	}
+
+	void engineUpdate()
+	{
+		DEGRID_SYSTEM_TIMING("grid");
+
+		if (!built)
+			return;
+
+		if (configuredDensity() != builtDensity || configuredRadius() != builtRadius)
+		{
+			for (Entity *e : markers.entities)
+				if (e)
+					e->add(entitiesToDestroy);
+			build();
+		}
+
+		updateChunks();
+		compactAwake(); // remove markers of deactivated chunks
+		applyExplosions();
+		if (!game.paused)
+		{
+			wakeByGravity();
+			simulate();
+		}
+		if (densityLevel != qualityLevel())
+			applyDensity();
+		synchronize();
+		reindex();
+
+		statistics.gridMarkersAwake = numeric_cast<uint32>(markers.awakeList.size());
+		statistics.gridMarkersAsleep = markers.count - statistics.gridMarkersAwake;
+	}
+
+	void gameStart()
+	{
+		// the entities of previous game are destroyed with all other entities
+		explosions.clear();
+		build();
+	}
+
+	class Callbacks
+	{
+		EventListener<void()> engineUpdateListener;
+		EventListener<void()> gameStartListener;
+	public:
+		Callbacks() : engineUpdateListener("grid"), gameStartListener("grid")
+		{
+			engineUpdateListener.attach(controlThread().update, 31); // after physics
+			engineUpdateListener.bind<&engineUpdate>();
+			gameStartListener.attach(gameStartEvent(), -5);
+			gameStartListener.bind<&gameStart>();
+		}
+	} callbacksInstance;
+}
+
+PointerRange<const uint32> gridMarkersQuery(const vec3 &center, real radius)
+{
+	queryResult.clear();
+	if (markers.count == 0)
+		return {};
+	staticLattice.query<true>(center[0].value, center[1].value, center[2].value, radius.value);
+	dynamicLattice.query<false>(center[0].value, center[1].value, center[2].value, radius.value);
+	return { queryResult.data(), queryResult.data() + queryResult.size() };
+}
+
+vec3 gridMarkerPosition(uint32 index)
+{
+	CAGE_ASSERT(index < markers.count);
+	return vec3(markers.position[0][index], markers.position[1][index], markers.position[2][index]);
+}
+
+vec3 gridMarkerColor(uint32 index)
+{
+	CAGE_ASSERT(index < markers.count);
+	return vec3(markers.color[0][index], markers.color[1][index], markers.color[2][index]);
+}
+
+void gridMarkerColor(uint32 index, const vec3 &color)
+{
+	CAGE_ASSERT(index < markers.count);
+	for (uint32 a = 0; a < 3; a++)
+		markers.color[a][index] = color[a].value;
+	markers.wake(index);
+}
+
+void gridMarkerImpulse(uint32 index, const vec3 &velocityChange, const vec3 &positionChange)
+{
+	CAGE_ASSERT(index < markers.count);
+	for (uint32 a = 0; a < 3; a++)
+	{
+		markers.velocity[a][index] += velocityChange[a].value;
+		markers.position[a][index] += positionChange[a].value;
+	}
+	markers.wake(index);
+}
+
+void gridMarkerTeleport(uint32 index, const vec3 &position)
+{
+	CAGE_ASSERT(index < markers.count);
+	CAGE_ASSERT(markers.entities[index]);
+	for (uint32 a = 0; a < 3; a++)
+		markers.position[a][index] = position[a].value;
+	markers.entities[index]->remove(TransformComponent::componentHistory);
+	markers.wake(index);
+}
+
+void gridMarkersScatter(const vec3 &center, const vec3 &extent)
+{
+	for (const GridChunk &c : chunks)
+	{
+		if (!c.active)
+			continue;
+		for (uint32 i = c.begin; i < c.end; i++)
+		{
+			const vec3 p = center + randomDirection3() * extent;
+			for (uint32 a = 0; a < 3; a++)
+				markers.position[a][i] = p[a].value;
+			markers.wake(i);
+		}
+	}
+}
+
+void gridExplosion(const vec3 &position, const vec3 &color, real size)
+{
+	if (!built)
+		return;
+	explosions.push_back({ position, color, size });
+}
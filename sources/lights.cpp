@@ -0,0 +1,139 @@
+#include <cage-core/entities.h>
+#include <cage-core/config.h>
+
+#include "game.h"
+
+#include <vector>
+#include <algorithm>
+
+ConfigUint32 confLightsBudget("degrid/lights/budget", 32);
+
+namespace
+{
+	constexpr float ClusterDistance = 8;
+	constexpr float ClusterColor = 0.01f; // squared
+
+	struct LightRequest
+	{
+		vec3 position;
+		vec3 color;
+		vec3 attenuation;
+		real intensity;
+		real weight;
+		Entity *source = nullptr;
+		uint32 priority = 0;
+	};
+
+	std::vector<LightRequest> requests;
+	std::vector<LightRequest> accepted;
+	std::vector<Entity *> pool;
+	std::vector<Entity *> poolSources; // source of the light in the previous tick
+
+	void engineUpdate()
+	{
+		DEGRID_SYSTEM_TIMING("lights");
+
+		requests.clear();
+		for (Entity *e : LightSourceComponent::component->entities())
+		{
+			CAGE_COMPONENT_ENGINE(Transform, t, e);
+			DEGRID_COMPONENT(LightSource, ls, e);
+			LightRequest r;
+			r.position = t.position;
+			r.color = ls.color;
+			r.attenuation = ls.attenuation;
+			r.intensity = ls.intensity;
+			r.weight = ls.intensity;
+			r.source = e;
+			r.priority = ls.priority;
+			requests.push_back(r);
+		}
+		std::stable_sort(requests.begin(), requests.end(), [](const LightRequest &a, const LightRequest &b) {
+			if (a.priority != b.priority)
+				return a.priority > b.priority;
+			return a.intensity > b.intensity;
+		});
+
+		const uint32 budget = confLightsBudget;
+		accepted.clear();
+		for (const LightRequest &r : requests)
+		{
+			bool merged = false;
+			for (LightRequest &a : accepted)
+			{
+				if (a.attenuation != r.attenuation)
+					continue;
+				if (distanceSquared(a.color, r.color) > ClusterColor)
+					continue;
+				if (distanceSquared(a.position, r.position) > ClusterDistance * ClusterDistance)
+					continue;
+				const real w = a.weight + r.weight;
+				if (w > 1e-5)
+					a.position = (a.position * a.weight + r.position * r.weight) / w;
+				a.weight = w;
+				a.intensity += r.intensity;
+				merged = true;
+				break;
+			}
+			if (merged)
+				statistics.lightsMerged++;
+			else if (accepted.size() < budget)
+				accepted.push_back(r);
+			else
+				statistics.lightsDropped++;
+		}
+
+		const uint32 cnt = numeric_cast<uint32>(accepted.size());
+		while (pool.size() < cnt)
+		{
+			pool.push_back(engineEntities()->createAnonymous());
+			poolSources.push_back(nullptr);
+		}
+		for (uint32 i = 0; i < cnt; i++)
+		{
+			const LightRequest &r = accepted[i];
+			Entity *e = pool[i];
+			CAGE_COMPONENT_ENGINE(Transform, t, e);
+			t.position = r.position;
+			if (poolSources[i] != r.source)
+			{
+				e->remove(TransformComponent::componentHistory);
+				poolSources[i] = r.source;
+			}
+			CAGE_COMPONENT_ENGINE(Light, l, e);
+			l.lightType = LightTypeEnum::Point;
+			l.color = r.color;
+			l.intensity = r.intensity;
+			l.attenuation = r.attenuation;
+		}
+		for (uint32 i = cnt; i < pool.size(); i++)
+		{
+			pool[i]->remove(LightComponent::component);
+			poolSources[i] = nullptr;
+		}
+
+		statistics.lightsCurrent = cnt;
+		statistics.lightsMax = max(statistics.lightsMax, cnt);
+	}
+
+	void gameStart()
+	{
+		// the pooled entities are destroyed with all other entities
+		pool.clear();
+		poolSources.clear();
+	}
+
+	class Callbacks
+	{
+		EventListener<void()> engineUpdateListener;
+		EventListener<void()> gameStartListener;
+	public:
+		Callbacks() : engineUpdateListener("lights"), gameStartListener("lights")
+		{
+			engineUpdateListener.attach(controlThread().update, 45); // after all light sources have moved
+			engineUpdateListener.bind<&engineUpdate>();
+			gameStartListener.attach(gameStartEvent());
+			gameStartListener.bind<&gameStart>();
+		}
+	} callbacksInstance;
+}
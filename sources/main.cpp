@@ -13,8 +13,26 @@ void reloadLanguage(uint32 index);
 
 namespace
 {
-	uint32 loadedLanguageHash;
 	uint32 currentLanguageHash;
+}
+
+void reloadLanguage(uint32 index)
+{
+	constexpr const uint32 Languages[] = {
+		HashString("degrid/languages/english.textpack"),
+		HashString("degrid/languages/czech.textpack")
+	};
+	if (index < sizeof(Languages) / sizeof(Languages[0]))
+		currentLanguageHash = Languages[index];
+	else
+		currentLanguageHash = 0;
+}
+
+#ifndef DEGRID_BENCH // the benchmark has its own entry point
+
+namespace
+{
+	uint32 loadedLanguageHash;
 
 	bool windowClose()
 	{
@@ -28,11 +46,18 @@ namespace
 			return false;
 
 		static ConfigBool secondaryCamera("degrid/secondaryCamera/enabled", false);
+		static ConfigBool overlay("degrid/overlay/enabled", false);
 
 		CAGE_LOG_DEBUG(SeverityEnum::Info, "keyboard", stringizer() + "key: " + key);
 
 		switch (key)
 		{
+		case 296: // F7
+			memoryReport();
+			return true;
+		case 297: // F8
+			overlay = !(bool)overlay;
+			return true;
 		case 298: // F9
 			secondaryCamera = !(bool)secondaryCamera;
 			return true;
@@ -43,6 +68,8 @@ namespace
 
 	void assetsUpdate()
 	{
+		DEGRID_SYSTEM_TIMING("assets");
+
 		if (currentLanguageHash != loadedLanguageHash)
 		{
 			if (loadedLanguageHash)
@@ -61,18 +88,6 @@ namespace
 	WindowEventListeners listeners;
 }
 
-void reloadLanguage(uint32 index)
-{
-	constexpr const uint32 Languages[] = {
-		HashString("degrid/languages/english.textpack"),
-		HashString("degrid/languages/czech.textpack")
-	};
-	if (index < sizeof(Languages) / sizeof(Languages[0]))
-		currentLanguageHash = Languages[index];
-	else
-		currentLanguageHash = 0;
-}
-
 int main(int argc, const char *args[])
 {
 	try
@@ -117,3 +132,5 @@ int main(int argc, const char *args[])
 	}
 	return 1;
 }
+
+#endif // DEGRID_BENCH
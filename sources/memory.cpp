@@ -0,0 +1,223 @@
+#include <cage-core/entities.h>
+#include <cage-core/assetManager.h>
+#include <cage-core/assetHeader.h>
+#include <cage-core/config.h>
+#include <cage-core/files.h>
+#include <cage-core/ini.h>
+#include <cage-core/geometry.h>
+#include <cage-engine/gui.h>
+
+#include "game.h"
+
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+
+namespace
+{
+	ConfigString confMemoryAssetsPath("degrid/memory/assetsPath", "assets"); // compiled assets, for reading their headers
+
+	// aabb and sphere per item plus a share of the tree nodes
+	constexpr uint32 SpatialItemBytes = sizeof(Aabb) + sizeof(Sphere) + 32;
+
+	struct ComponentMemory
+	{
+		const char *name = nullptr;
+		EntityComponent *component = nullptr;
+		uint32 size = 0;
+		uint64 bytes = 0;
+	};
+
+	std::vector<ComponentMemory> components;
+
+	struct AssetFile
+	{
+		uint64 size = 0; // decompressed payload
+		std::vector<uint32> dependencies;
+		bool found = false;
+	};
+
+	std::unordered_map<uint32, AssetFile> assetFiles; // compiled assets do not change while running
+
+	struct PackCategory
+	{
+		const char *name;
+		uint32 packs[8];
+	};
+
+	constexpr const PackCategory PackCategories[] = {
+		{ "monster", { HashString("degrid/monster/monster.pack"), HashString("degrid/monster/snakeTail.pack"), HashString("degrid/monster/shocker/shocker.pack"), HashString("degrid/monster/wormhole.pack") } },
+		{ "boss", { HashString("degrid/boss/boss.pack") } },
+		{ "environment", { HashString("degrid/environment/environment.pack") } },
+		{ "skyboxes", { HashString("degrid/environment/skyboxes/skyboxes.pack"),
+			HashString("degrid/environment/skyboxes/stage0.pack"), HashString("degrid/environment/skyboxes/stage1.pack"), HashString("degrid/environment/skyboxes/stage2.pack"),
+			HashString("degrid/environment/skyboxes/stage3.pack"), HashString("degrid/environment/skyboxes/stage4.pack"), HashString("degrid/environment/skyboxes/stage5.pack") } },
+		{ "music", { HashString("degrid/music/music.pack") } },
+		{ "speech", { HashString("degrid/speech/speech.pack") } },
+	};
+
+	const AssetFile &assetFile(uint32 name)
+	{
+		auto it = assetFiles.find(name);
+		if (it != assetFiles.end())
+			return it->second;
+		AssetFile &a = assetFiles[name];
+		const string path = pathJoin(confMemoryAssetsPath, stringizer() + name);
+		if (!pathIsFile(path))
+			return a;
+		try
+		{
+			Holder<File> f = newFile(path, FileMode(true, false));
+			AssetHeader h;
+			f->read({ (char *)&h, (char *)(&h + 1) });
+			a.dependencies.resize(h.dependenciesCount);
+			f->read({ (char *)a.dependencies.data(), (char *)(a.dependencies.data() + a.dependencies.size()) });
+			a.size = h.originalSize > 0 ? h.originalSize : f->size() - f->tell();
+			a.found = true;
+		}
+		catch (...)
+		{
+			CAGE_LOG(SeverityEnum::Warning, "memory", stringizer() + "failed to read header of asset: " + name);
+		}
+		return a;
+	}
+
+	uint64 assetBytes(uint32 name, std::unordered_set<uint32> &visited, uint32 &missing)
+	{
+		if (!visited.insert(name).second)
+			return 0;
+		const AssetFile &a = assetFile(name);
+		if (!a.found)
+			missing++;
+		uint64 res = a.size;
+		for (uint32 d : a.dependencies)
+			res += assetBytes(d, visited, missing);
+		return res;
+	}
+
+	bool packLoaded(uint32 name)
+	{
+		return !!engineAssets()->get<AssetSchemeIndexPack, AssetPack>(name);
+	}
+
+	void reportValue(const string &item, uint64 value)
+	{
+		if (Ini *report = gameReport())
+			report->setString("memory", item, stringizer() + value);
+	}
+
+	void engineComponents(std::vector<ComponentMemory> &res)
+	{
+		const auto &add = [&](const char *name, EntityComponent *component, uint32 size) {
+			ComponentMemory c;
+			c.name = name;
+			c.component = component;
+			c.size = size;
+			res.push_back(c);
+		};
+		add("Transform", TransformComponent::component, sizeof(TransformComponent));
+		add("TransformHistory", TransformComponent::componentHistory, sizeof(TransformComponent));
+		add("Render", RenderComponent::component, sizeof(RenderComponent));
+		add("TextureAnimation", TextureAnimationComponent::component, sizeof(TextureAnimationComponent));
+		add("SkeletalAnimation", SkeletalAnimationComponent::component, sizeof(SkeletalAnimationComponent));
+		add("Light", LightComponent::component, sizeof(LightComponent));
+		add("Camera", CameraComponent::component, sizeof(CameraComponent));
+		add("Sound", SoundComponent::component, sizeof(SoundComponent));
+		add("Listener", ListenerComponent::component, sizeof(ListenerComponent));
+	}
+
+	void gameStop()
+	{
+		memoryReport();
+	}
+
+	class Callbacks
+	{
+		EventListener<void()> gameStopListener;
+	public:
+		Callbacks() : gameStopListener("memory")
+		{
+			gameStopListener.attach(gameStopEvent(), 59); // before the game report is saved
+			gameStopListener.bind<&gameStop>();
+		}
+	} callbacksInstance;
+}
+
+void memoryComponent(const char *name, EntityComponent *component, uint32 size)
+{
+	ComponentMemory c;
+	c.name = name;
+	c.component = component;
+	c.size = size;
+	components.push_back(c);
+}
+
+void memoryReport()
+{
+	uint64 total = 0;
+
+	{ // components
+		std::vector<ComponentMemory> all = components;
+		engineComponents(all);
+		for (ComponentMemory &c : all)
+			c.bytes = uint64(c.component->group()->count()) * c.size;
+		std::sort(all.begin(), all.end(), [](const ComponentMemory &a, const ComponentMemory &b) {
+			return a.bytes > b.bytes;
+		});
+		uint64 sum = 0;
+		for (const ComponentMemory &c : all)
+		{
+			CAGE_LOG(SeverityEnum::Info, "memory", stringizer() + "component '" + c.name + "': " + c.bytes + " B (" + c.component->group()->count() + " x " + c.size + " B)");
+			reportValue(stringizer() + "component." + c.name, c.bytes);
+			sum += c.bytes;
+		}
+		CAGE_LOG(SeverityEnum::Info, "memory", stringizer() + "components total: " + sum + " B, entities: " + statistics.entitiesCurrent);
+		reportValue("components", sum);
+		total += sum;
+	}
+
+	{ // spatial structure
+		const uint64 bytes = uint64(statistics.spatialItemsCurrent) * SpatialItemBytes;
+		CAGE_LOG(SeverityEnum::Info, "memory", stringizer() + "spatial structure: " + bytes + " B (" + statistics.spatialItemsCurrent + " items)");
+		reportValue("spatial", bytes);
+		total += bytes;
+	}
+
+	{ // gui
+		const uint32 cnt = engineGui()->entities()->group()->count();
+		CAGE_LOG(SeverityEnum::Info, "memory", stringizer() + "gui entities: " + cnt);
+		reportValue("guiEntities", cnt);
+	}
+
+	{ // assets
+		for (const PackCategory &c : PackCategories)
+		{
+			// shared dependencies are counted once per category
+			std::unordered_set<uint32> visitedLoaded, visitedAll;
+			uint32 missing = 0, ignored = 0;
+			uint64 loaded = 0, all = 0;
+			uint32 packs = 0;
+			for (uint32 p : c.packs)
+			{
+				if (!p)
+					continue;
+				all += assetBytes(p, visitedAll, missing);
+				if (packLoaded(p))
+				{
+					loaded += assetBytes(p, visitedLoaded, ignored);
+					packs++;
+				}
+			}
+			string line = stringizer() + "assets '" + c.name + "': " + loaded + " B loaded (" + packs + " packs), " + all + " B all";
+			if (missing)
+				line += stringizer() + ", " + missing + " assets not found";
+			CAGE_LOG(SeverityEnum::Info, "memory", line);
+			reportValue(stringizer() + "assets." + c.name, loaded);
+			total += loaded;
+		}
+	}
+
+	CAGE_LOG(SeverityEnum::Info, "memory", stringizer() + "estimated total: " + total + " B");
+	reportValue("total", total);
+}
@@ -49,13 +49,14 @@ namespace
 	void engineInit()
 	{
 		BossEggComponent::component = engineEntities()->defineComponent(BossEggComponent());
+		DEGRID_MEMORY_COMPONENT(BossEgg);
 		eggDestroyedListener.attach(BossEggComponent::component->group()->entityRemoved);
 		eggDestroyedListener.bind<&eggDestroyed>();
 	}
 
 	void engineUpdate()
 	{
-		OPTICK_EVENT("boss egg");
+		DEGRID_SYSTEM_TIMING("boss egg");
 
 		if (game.paused)
 			return;
@@ -93,6 +94,8 @@ namespace
 
 	void lateUpdate()
 	{
+		DEGRID_SYSTEM_TIMING("boss egg late");
+
 		for (Entity *e : BossEggComponent::component->entities())
 		{
 			CAGE_COMPONENT_ENGINE(Transform, tr, e);
@@ -126,6 +129,7 @@ void spawnBossEgg(const vec3 &spawnPosition, const vec3 &color)
 	CAGE_ASSERT(BossComponent::component->group()->count() == 0);
 	if (game.defeatedBosses >= BossesTotalCount)
 		return;
+	skyboxesPrefetch(game.defeatedBosses + 1);
 	Entity *e = initializeMonster(spawnPosition, color, 10, HashString("degrid/boss/egg.object"), 0, real::Infinity(), real::Infinity());
 	DEGRID_COMPONENT(BossEgg, eggc, e);
 	{
@@ -55,7 +55,7 @@ namespace
 				Entity *e = engineEntities()->get(b.bulbs[b.cannonsKilled]);
 				CAGE_COMPONENT_ENGINE(Render, r, e);
 				r.color = vec3(r.color[1], r.color[0], r.color[2]);
-				CAGE_COMPONENT_ENGINE(Light, l, e);
+				DEGRID_COMPONENT(LightSource, l, e);
 				l.color = vec3(l.color[1], l.color[0], l.color[2]);
 			}
 			b.cannonsKilled++;
@@ -81,7 +81,9 @@ namespace
 	void engineInit()
 	{
 		BodyComponent::component = engineEntities()->defineComponent(BodyComponent());
+		DEGRID_MEMORY_COMPONENT(Body);
 		CannonComponent::component = engineEntities()->defineComponent(CannonComponent());
+		DEGRID_MEMORY_COMPONENT(Cannon);
 		bodyEliminatedListener.bind<&bodyEliminated>();
 		bodyEliminatedListener.attach(BodyComponent::component->group()->entityRemoved);
 		cannonEliminatedListener.bind<&cannonEliminated>();
@@ -90,7 +92,7 @@ namespace
 
 	void engineUpdate()
 	{
-		OPTICK_EVENT("cannoneer boss");
+		DEGRID_SYSTEM_TIMING("cannoneer boss");
 
 		if (game.paused)
 			return;
@@ -145,6 +147,8 @@ namespace
 
 	void engineUpdateLate()
 	{
+		DEGRID_SYSTEM_TIMING("cannoneer boss late");
+
 		if (game.paused)
 			return;
 
@@ -220,6 +224,10 @@ namespace
 	{
 		CAGE_COMPONENT_ENGINE(Transform, bt, body);
 		Entity *cannon = initializeMonster(bt.position, vec3(0.188, 0.08, 0.076), 5, HashString("degrid/boss/cannoneerCannon.object"), HashString("degrid/monster/boss/cannoneer-cannon-bum.ogg"), 30, real::Infinity());
+		{
+			DEGRID_COMPONENT(Monster, m, cannon);
+			m.defeatedSoundPriority = SoundPriorityEnum::Boss;
+		}
 		DEGRID_COMPONENT(Cannon, c, cannon);
 		c.bodyEntity = body->name();
 		c.index = index;
@@ -237,6 +245,8 @@ void spawnBossCannoneer(const vec3 &spawnPosition, const vec3 &color)
 	DEGRID_COMPONENT(Body, b, body);
 	{ // body
 		DEGRID_COMPONENT(Boss, boss, body);
+		DEGRID_COMPONENT(Monster, m, body);
+		m.defeatedSoundPriority = SoundPriorityEnum::Boss;
 		DEGRID_COMPONENT(Rotation, rotation, body);
 		rotation.rotation = quat(degs(), degs(0.55), degs());
 		DEGRID_COMPONENT(SimpleMonster, simple, body);
@@ -253,11 +263,11 @@ void spawnBossCannoneer(const vec3 &spawnPosition, const vec3 &color)
 			CAGE_COMPONENT_ENGINE(Render, r, e);
 			r.object = HashString("degrid/boss/cannoneerBulb.object");
 			r.color = vec3(0.022, 0.428, 0.025);
-			CAGE_COMPONENT_ENGINE(Light, l, e);
+			DEGRID_COMPONENT(LightSource, l, e);
 			l.color = r.color;
 			l.intensity = 50;
-			l.lightType = LightTypeEnum::Point;
 			l.attenuation = vec3(1, 0, 1);
+			l.priority = 3;
 		}
 	}
 	{ // shield
@@ -1,20 +1,124 @@
-#include <cage-core/color.h>
-
 #include "monsters.h"
 
+#include <vector>
+#include <algorithm>
+
+PlayerProximity playerProximity;
+
 namespace
 {
 	bool wasBoss = false;
 
+	struct KillEvent
+	{
+		vec3 position;
+		vec3 velocity;
+		vec3 color;
+		real size;
+		uint32 name = 0;
+		uint32 sound = 0;
+		SoundPriorityEnum soundPriority = SoundPriorityEnum::Debris;
+		uint32 score = 0;
+		Delegate<void(uint32)> callback;
+	};
+
+	struct KillExplosion
+	{
+		vec3 position;
+		vec3 velocity;
+		vec3 color;
+		real weight; // sum of squared sizes of the merged explosions
+	};
+
+	std::vector<KillEvent> killEvents;
+	std::vector<KillExplosion> killExplosions;
+	std::vector<uint32> killSounds;
+
+	constexpr float KillCoalesceDistance = 8;
+	constexpr float KillCoalesceColor = 0.02; // squared distance in rgb
+
+	void processKills()
+	{
+		DEGRID_SYSTEM_TIMING("kills");
+
+		if (killEvents.empty())
+			return;
+
+		// callbacks may kill more monsters, those are processed in this same pass
+		for (uint32 i = 0; i < killEvents.size(); i++)
+		{
+			const KillEvent k = killEvents[i];
+			game.score += k.score;
+			if (k.callback && engineEntities()->has(k.name))
+				k.callback(k.name);
+		}
+
+		// merge nearby explosions of similar color
+		killExplosions.clear();
+		for (const KillEvent &k : killEvents)
+		{
+			const real w = sqr(k.size);
+			bool merged = false;
+			for (KillExplosion &x : killExplosions)
+			{
+				if (distanceSquared(x.position, k.position) > sqr(KillCoalesceDistance) || distanceSquared(x.color, k.color) > KillCoalesceColor)
+					continue;
+				const real f = w / (x.weight + w);
+				x.position = interpolate(x.position, k.position, f);
+				x.velocity = interpolate(x.velocity, k.velocity, f);
+				x.color = interpolate(x.color, k.color, f);
+				x.weight += w;
+				merged = true;
+				statistics.killExplosionsCoalesced++;
+				break;
+			}
+			if (!merged)
+			{
+				KillExplosion x;
+				x.position = k.position;
+				x.velocity = k.velocity;
+				x.color = k.color;
+				x.weight = w;
+				killExplosions.push_back(x);
+			}
+		}
+		for (const KillExplosion &x : killExplosions)
+			environmentExplosion(x.position, x.velocity, x.color, sqrt(x.weight));
+
+		// play each sound once
+		killSounds.clear();
+		for (const KillEvent &k : killEvents)
+		{
+			if (!k.sound)
+				continue;
+			if (std::find(killSounds.begin(), killSounds.end(), k.sound) != killSounds.end())
+			{
+				statistics.killSoundsCoalesced++;
+				continue;
+			}
+			killSounds.push_back(k.sound);
+			soundEffect(k.sound, k.position, k.soundPriority);
+		}
+
+		killEvents.clear();
+	}
+
+	void gameStart()
+	{
+		killEvents.clear();
+		playerProximity = PlayerProximity();
+	}
+
 	void engineUpdate()
 	{
-		OPTICK_EVENT("monsters");
+		DEGRID_SYSTEM_TIMING("monsters");
 
 		if (game.paused)
 			return;
 
 		CAGE_COMPONENT_ENGINE(Transform, playerTransform, game.playerEntity);
 		DEGRID_COMPONENT(Velocity, playerVelocity, game.playerEntity);
+		PlayerProximity proximity;
 
 		for (Entity *e : MonsterComponent::component->entities())
 		{
@@ -22,13 +126,25 @@ namespace
 			DEGRID_COMPONENT(Velocity, v, e);
 			DEGRID_COMPONENT(Monster, m, e);
 
+			// proximity to player
+			{
+				const real d = distance(t.position, playerTransform.position);
+				if (d < proximity.closestDistance)
+				{
+					proximity.closestDistance = d;
+					proximity.closestMonster = e->name();
+				}
+				for (uint32 i = 0; i < PlayerProximityRadiiCount; i++)
+					if (d < PlayerProximityRadii[i])
+						proximity.within[i]++;
+			}
+
 			// monster dispersion
 			if (m.dispersion > 0)
 			{
 				uint32 myName = e->name();
 				vec3 dispersion;
-				spatialSearchQuery->intersection(Sphere(t.position, t.scale + 1));
-				for (uint32 otherName : spatialSearchQuery->result())
+				for (uint32 otherName : spatialQuery(SpatialSiteEnum::MonstersDispersion, Sphere(t.position, t.scale + 1)))
 				{
 					if (otherName == myName)
 						continue;
@@ -37,6 +153,7 @@ namespace
 					vec3 toMonster = t.position - ot.position;
 					if (e->has(MonsterComponent::component))
 					{
+						spatialQueryUsed(SpatialSiteEnum::MonstersDispersion);
 						real d = ot.scale + t.scale;
 						if (lengthSquared(toMonster) < d*d)
 							dispersion += normalize(toMonster) / length(toMonster);
@@ -81,7 +198,7 @@ namespace
 							HashString("degrid/speech/damage/we-have-been-hit.wav"),
 							0
 						};
-						soundSpeech(Sounds);
+						soundSpeech(Sounds, SpeechCategoryEnum::Damage);
 					}
 				}
 				if (m.life < real::Infinity())
@@ -92,6 +209,7 @@ namespace
 			v.velocity[1] = 0;
 			t.position[1] = m.groundLevel;
 		}
+		playerProximity = proximity;
 
 		const bool hasBoss = BossComponent::component->group()->count() > 0;
 		if (!game.cinematic)
@@ -114,11 +232,17 @@ namespace
 	class Callbacks
 	{
 		EventListener<void()> engineUpdateListener;
+		EventListener<void()> killsUpdateListener;
+		EventListener<void()> gameStartListener;
 	public:
-		Callbacks() : engineUpdateListener("monsters")
+		Callbacks() : engineUpdateListener("monsters"), killsUpdateListener("kills"), gameStartListener("kills")
 		{
 			engineUpdateListener.attach(controlThread().update, 1);
 			engineUpdateListener.bind<&engineUpdate>();
+			killsUpdateListener.attach(controlThread().update, 25); // before physics destroys the entities
+			killsUpdateListener.bind<&processKills>();
+			gameStartListener.attach(gameStartEvent());
+			gameStartListener.bind<&gameStart>();
 		}
 	} callbacksInstance;
 }
@@ -177,23 +301,26 @@ bool killMonster(Entity *e, bool allowCallback)
 	if (e->has(entitiesToDestroy))
 		return false;
 	e->add(entitiesToDestroy);
-	monsterExplosion(e);
+	CAGE_COMPONENT_ENGINE(Transform, t, e);
+	CAGE_COMPONENT_ENGINE(Render, r, e);
+	DEGRID_COMPONENT(Velocity, v, e);
 	DEGRID_COMPONENT(Monster, m, e);
 	m.life = 0;
-	game.score += numeric_cast<uint32>(clamp(m.damage, 1, 200));
-	if (m.defeatedSound)
-	{
-		CAGE_COMPONENT_ENGINE(Transform, t, e);
-		soundEffect(m.defeatedSound, t.position);
-		m.defeatedSound = 0;
-	}
-	if (!allowCallback)
-		return false;
-	if (m.defeatedCallback)
-	{
-		m.defeatedCallback(e->name());
-		m.defeatedCallback.clear();
-		return false;
-	}
-	return true;
+	statistics.killsQueued++;
+	KillEvent k;
+	k.position = t.position;
+	k.velocity = v.velocity;
+	k.color = r.color;
+	k.size = t.scale;
+	k.name = e->name();
+	k.sound = m.defeatedSound;
+	k.soundPriority = m.defeatedSoundPriority;
+	k.score = numeric_cast<uint32>(clamp(m.damage, 1, 200));
+	m.defeatedSound = 0;
+	const bool result = allowCallback && !m.defeatedCallback;
+	if (allowCallback)
+		k.callback = m.defeatedCallback;
+	m.defeatedCallback.clear();
+	killEvents.push_back(k);
+	return result;
 }
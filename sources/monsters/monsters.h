@@ -31,6 +31,8 @@ namespace cage
 }
 
 void spawnGeneral(MonsterTypeFlags type, const vec3 &spawnPosition, const vec3 &color);
+void monstersPrefetch(MonsterTypeFlags types);
+void monstersSpawnDefinition(const string &name, uint32 count); // spawns count monsters (0 = up to the limit) as the named definition would
 void spawnSimple(MonsterTypeFlags type, const vec3 &spawnPosition, const vec3 &color);
 void spawnSnake(const vec3 &spawnPosition, const vec3 &color);
 void spawnShielder(const vec3 &spawnPosition, const vec3 &color);
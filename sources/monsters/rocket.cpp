@@ -12,16 +12,17 @@ namespace
 	void engineInit()
 	{
 		RocketMonsterComponent::component = engineEntities()->defineComponent(RocketMonsterComponent());
+		DEGRID_MEMORY_COMPONENT(RocketMonster);
 	}
 
 	void engineUpdate()
 	{
-		OPTICK_EVENT("rocket");
+		DEGRID_SYSTEM_TIMING("rocket");
 
 		if (game.paused)
 			return;
 
-		real disapearDistance2 = MapNoPullRadius * 2;
+		real disapearDistance2 = mapNoPullRadius() * 2;
 		disapearDistance2 *= disapearDistance2;
 		for (Entity *e : RocketMonsterComponent::component->entities())
 		{
@@ -32,24 +33,11 @@ namespace
 			{
 				tr.orientation = tr.orientation * quat(degs(), degs(), degs(3));
 
-				if ((e->name() + statistics.updateIterationIgnorePause) % 3 == 0)
+				if ((e->name() + statistics.updateIterationIgnorePause) % 3 == 0 && randomChance() < qualityScale())
 				{
-					Entity *spark = engineEntities()->createAnonymous();
-					CAGE_COMPONENT_ENGINE(Transform, transform, spark);
-					transform.scale = randomChance() * 0.2 + 0.3;
-					transform.position = tr.position + (tr.orientation * vec3(0, 0, 1.2) + randomDirection3() * 0.3) * tr.scale;
-					transform.orientation = randomDirectionQuat();
-					CAGE_COMPONENT_ENGINE(Render, render, spark);
-					render.object = HashString("degrid/environment/spark.object");
 					DEGRID_COMPONENT(Velocity, v, e);
-					DEGRID_COMPONENT(Velocity, vel, spark);
-					vel.velocity = (v.velocity + randomDirection3() * 0.05) * randomChance() * -0.5;
-					DEGRID_COMPONENT(Timeout, ttl, spark);
-					ttl.ttl = randomRange(10, 15);
-					CAGE_COMPONENT_ENGINE(TextureAnimation, at, spark);
-					at.startTime = engineControlTime();
-					at.speed = 30.f / ttl.ttl;
-					spark->add(entitiesPhysicsEvenWhenPaused);
+					vec3 pos = tr.position + (tr.orientation * vec3(0, 0, 1.2) + randomDirection3() * 0.3) * tr.scale;
+					particleSpark(ParticleEmitterEnum::Rocket, pos, (v.velocity + randomDirection3() * 0.05) * randomChance() * -0.5, randomChance() * 0.2 + 0.3, randomRange(10, 15));
 				}
 			}
 		}
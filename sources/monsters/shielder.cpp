@@ -23,6 +23,8 @@ namespace
 
 	void updateShields()
 	{
+		DEGRID_SYSTEM_TIMING("shields");
+
 		// update shields transformations
 		for (Entity *e : ShielderComponent::component->entities())
 		{
@@ -46,14 +48,16 @@ namespace
 	void engineInit()
 	{
 		ShielderComponent::component = engineEntities()->defineComponent(ShielderComponent());
+		DEGRID_MEMORY_COMPONENT(Shielder);
 		ShieldComponent::component = engineEntities()->defineComponent(ShieldComponent());
+		DEGRID_MEMORY_COMPONENT(Shield);
 		shielderEliminatedListener.bind<&shielderEliminated>();
 		shielderEliminatedListener.attach(ShielderComponent::component->group()->entityRemoved);
 	}
 
 	void engineUpdate()
 	{
-		OPTICK_EVENT("shielder");
+		DEGRID_SYSTEM_TIMING("shielder");
 
 		if (game.paused)
 			return;
@@ -115,12 +119,12 @@ namespace
 
 			// destroy shots
 			vec3 forward = tr.orientation * vec3(0, 0, -1);
-			spatialSearchQuery->intersection(Sphere(tr.position + forward * (tr.scale + 1), 5));
-			for (uint32 otherName : spatialSearchQuery->result())
+			for (uint32 otherName : spatialQuery(SpatialSiteEnum::ShielderShots, Sphere(tr.position + forward * (tr.scale + 1), 5)))
 			{
 				Entity *e = engineEntities()->get(otherName);
 				if (!e->has(ShotComponent::component))
 					continue;
+				spatialQueryUsed(SpatialSiteEnum::ShielderShots);
 				CAGE_COMPONENT_ENGINE(Transform, ot, e);
 				vec3 toShot = ot.position - tr.position;
 				vec3 dirShot = normalize(toShot);
@@ -2,55 +2,125 @@
 
 namespace
 {
+	constexpr uint32 MaxBoltSegments = 8;
+	constexpr uint32 MaxBoltLights = 2; // per bolt chain
+	constexpr uint32 BoltTtl = 3;
+
 	struct ShockerComponent
 	{
 		static EntityComponent *component;
+		uint32 bolts[MaxBoltSegments] = {}; // pooled segment entities
+		uint32 boltTtl = 0;
 		real radius;
 		real speedFactor;
 	};
 
 	EntityComponent *ShockerComponent::component;
 
+	struct BoltSegment
+	{
+		vec3 position;
+		vec3 direction;
+	};
+
+	BoltSegment segments[MaxBoltSegments];
+	uint32 segmentsCount;
+
+	void shockerEliminated(Entity *e)
+	{
+		DEGRID_COMPONENT(Shocker, sh, e);
+		for (uint32 it : sh.bolts)
+		{
+			if (engineEntities()->has(it))
+				engineEntities()->get(it)->add(entitiesToDestroy);
+		}
+	}
+
+	EventListener<void(Entity*)> shockerEliminatedListener;
+
 	void engineInit()
 	{
 		ShockerComponent::component = engineEntities()->defineComponent(ShockerComponent());
+		DEGRID_MEMORY_COMPONENT(Shocker);
+		shockerEliminatedListener.bind<&shockerEliminated>();
+		shockerEliminatedListener.attach(ShockerComponent::component->group()->entityRemoved);
 	}
 
-	void lightning(const vec3 &a, const vec3 &b, const vec3 &color)
+	void lightningSegments(const vec3 &a, const vec3 &b, uint32 budget)
 	{
 		real d = distance(a, b);
 		vec3 v = normalize(b - a);
 		vec3 c = (a + b) * 0.5;
-		if (d > 25)
+		if (d > 25 / qualityScale() && budget >= 2)
 		{
 			vec3 side = normalize(cross(v, vec3(0, 1, 0)));
 			c += side * (d * randomRange(-0.2, 0.2));
-			lightning(a, c, color);
-			lightning(c, b, color);
+			lightningSegments(a, c, budget / 2);
+			lightningSegments(c, b, budget / 2);
 			return;
 		}
-		Entity *e = engineEntities()->createUnique();
-		CAGE_COMPONENT_ENGINE(Transform, t, e);
-		t.position = c;
-		t.orientation = quat(v, vec3(0, 1, 0), true);
-		CAGE_COMPONENT_ENGINE(Render, r, e);
-		r.object = HashString("degrid/monster/shocker/lightning.object");
-		r.color = color;
-		CAGE_COMPONENT_ENGINE(TextureAnimation, anim, e);
-		anim.offset = randomChance();
-		DEGRID_COMPONENT(Timeout, ttl, e);
-		ttl.ttl = 3;
-		e->add(entitiesPhysicsEvenWhenPaused);
-		CAGE_COMPONENT_ENGINE(Light, light, e);
-		light.color = colorVariation(color);
-		light.intensity = 10;
-		light.lightType = LightTypeEnum::Point;
-		light.attenuation = vec3(0, 0, 0.01);
+		CAGE_ASSERT(segmentsCount < MaxBoltSegments);
+		BoltSegment &s = segments[segmentsCount++];
+		s.position = c;
+		s.direction = v;
+	}
+
+	void hideBolts(ShockerComponent &sh)
+	{
+		for (uint32 it : sh.bolts)
+		{
+			if (!engineEntities()->has(it))
+				continue;
+			Entity *e = engineEntities()->get(it);
+			e->remove(RenderComponent::component);
+			e->remove(LightSourceComponent::component);
+		}
+		sh.boltTtl = 0;
+	}
+
+	void lightning(ShockerComponent &sh, const vec3 &a, const vec3 &b, const vec3 &color)
+	{
+		hideBolts(sh);
+		segmentsCount = 0;
+		lightningSegments(a, b, MaxBoltSegments);
+		const uint32 lightsStep = (segmentsCount + MaxBoltLights - 1) / MaxBoltLights;
+		const uint32 lightsCount = (segmentsCount + lightsStep - 1) / lightsStep;
+		for (uint32 i = 0; i < segmentsCount; i++)
+		{
+			if (!engineEntities()->has(sh.bolts[i]))
+				sh.bolts[i] = engineEntities()->createUnique()->name();
+			Entity *e = engineEntities()->get(sh.bolts[i]);
+			CAGE_COMPONENT_ENGINE(Transform, t, e);
+			t.position = segments[i].position;
+			t.orientation = quat(segments[i].direction, vec3(0, 1, 0), true);
+			e->remove(TransformComponent::componentHistory);
+			CAGE_COMPONENT_ENGINE(Render, r, e);
+			r.object = HashString("degrid/monster/shocker/lightning.object");
+			r.color = color;
+			CAGE_COMPONENT_ENGINE(TextureAnimation, anim, e);
+			anim.offset = randomChance();
+			if ((i % lightsStep) == 0)
+			{
+				DEGRID_COMPONENT(LightSource, light, e);
+				light.color = colorVariation(color);
+				light.intensity = 10.f * segmentsCount / lightsCount; // keep the total intensity of the chain
+				light.attenuation = vec3(0, 0, 0.01);
+				light.priority = 2;
+			}
+		}
+		sh.boltTtl = BoltTtl;
 	}
 
 	void engineUpdate()
 	{
-		OPTICK_EVENT("shocker");
+		DEGRID_SYSTEM_TIMING("shocker");
+
+		for (Entity *e : ShockerComponent::component->entities())
+		{
+			DEGRID_COMPONENT(Shocker, sh, e);
+			if (sh.boltTtl > 0 && --sh.boltTtl == 0)
+				hideBolts(sh);
+		}
 
 		if (game.paused)
 		{
@@ -83,7 +153,7 @@ namespace
 				if (((statistics.updateIterationIgnorePause + e->name()) % 3) == 0)
 				{
 					CAGE_COMPONENT_ENGINE(Render, r, e);
-					lightning(tr.position + randomDirection3() * tr.scale, playerTransform.position + randomDirection3() * playerTransform.scale, r.color);
+					lightning(sh, tr.position + randomDirection3() * tr.scale, playerTransform.position + randomDirection3() * playerTransform.scale, r.color);
 				}
 				if (!e->has(SoundComponent::component))
 				{
@@ -7,6 +7,7 @@ namespace
 	void engineInit()
 	{
 		SimpleMonsterComponent::component = engineEntities()->defineComponent(SimpleMonsterComponent());
+		DEGRID_MEMORY_COMPONENT(SimpleMonster);
 	}
 
 	void spawnSmallCube(uint32 originalEntity)
@@ -29,7 +30,7 @@ namespace
 
 	void engineUpdate()
 	{
-		OPTICK_EVENT("simple monsters");
+		DEGRID_SYSTEM_TIMING("simple monsters");
 
 		if (game.paused)
 			return;
@@ -67,8 +68,7 @@ namespace
 				{
 					real closestDistance = real::Infinity();
 					uint32 myName = e->name();
-					spatialSearchQuery->intersection(Sphere(tr.position, 15));
-					for (uint32 otherName : spatialSearchQuery->result())
+					for (uint32 otherName : spatialQuery(SpatialSiteEnum::SimpleMonstersAvoidance, Sphere(tr.position, 15)))
 					{
 						if (otherName == myName)
 							continue;
@@ -77,6 +77,7 @@ namespace
 
 						if (!e->has(ShotComponent::component))
 							continue;
+						spatialQueryUsed(SpatialSiteEnum::SimpleMonstersAvoidance);
 
 						CAGE_COMPONENT_ENGINE(Transform, ot, e);
 						vec3 toMonster = tr.position - ot.position;
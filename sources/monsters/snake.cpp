@@ -21,7 +21,9 @@ namespace
 	void engineInit()
 	{
 		SnakeTailComponent::component = engineEntities()->defineComponent(SnakeTailComponent());
+		DEGRID_MEMORY_COMPONENT(SnakeTail);
 		SnakeHeadComponent::component = engineEntities()->defineComponent(SnakeHeadComponent());
+		DEGRID_MEMORY_COMPONENT(SnakeHead);
 	}
 
 	void snakeSideMove(vec3 &p, const quat &forward, uint32 index, real dist)
@@ -32,7 +34,7 @@ namespace
 
 	void engineUpdate()
 	{
-		OPTICK_EVENT("snake");
+		DEGRID_SYSTEM_TIMING("snake");
 
 		if (game.paused)
 			return;
@@ -101,6 +103,8 @@ namespace
 
 	void subtractSnakeTails()
 	{
+		DEGRID_SYSTEM_TIMING("snake tails");
+
 		// snake tails should not count towards monster limit
 		uint32 sub = SnakeTailComponent::component->group()->count();
 		statistics.monstersCurrent = sub < statistics.monstersCurrent ? statistics.monstersCurrent - sub : 0;
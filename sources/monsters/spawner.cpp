@@ -19,11 +19,12 @@ namespace
 	void engineInit()
 	{
 		SpawnerComponent::component = engineEntities()->defineComponent(SpawnerComponent());
+		DEGRID_MEMORY_COMPONENT(Spawner);
 	}
 
 	void engineUpdate()
 	{
-		OPTICK_EVENT("spawner");
+		DEGRID_SYSTEM_TIMING("spawner");
 
 		if (game.paused)
 			return;
@@ -99,6 +100,7 @@ void spawnSpawner(const vec3 &spawnPosition, const vec3 &color)
 	DEGRID_COMPONENT(Monster, m, spawner);
 	DEGRID_COMPONENT(Spawner, s, spawner);
 	s.type = pickOne(Types[game.defeatedBosses]);
+	monstersPrefetch(s.type);
 	s.count = 60 + 15 * monsterMutation(special);
 	s.period = numeric_cast<uint32>(25.0 / (3 + monsterMutation(special))) + 1;
 	DEGRID_COMPONENT(Rotation, rotation, spawner);
@@ -1,4 +1,5 @@
-#include <cage-core/color.h>
+#include <cage-core/assetManager.h>
+#include <cage-core/ini.h>
 
 #include "monsters.h"
 
@@ -63,6 +64,48 @@ namespace
 
 	std::vector<SpawnDefinition> definitions;
 
+	// monsters with large animated textures are loaded only when they are about to spawn
+	struct MonsterPack
+	{
+		MonsterTypeFlags types;
+		uint32 name;
+	};
+
+	constexpr const MonsterPack MonsterPacks[] = {
+		{ MonsterTypeFlags::Snake, HashString("degrid/monster/snakeTail.pack") },
+		{ MonsterTypeFlags::Shocker, HashString("degrid/monster/shocker/shocker.pack") },
+		{ MonsterTypeFlags::Wormhole, HashString("degrid/monster/wormhole.pack") },
+	};
+
+	constexpr uint32 SpawnLookahead = 4; // number of upcoming definitions whose monsters are prefetched
+
+	MonsterTypeFlags packsLoaded = MonsterTypeFlags::None;
+
+	MonsterTypeFlags upcomingTypes()
+	{
+		MonsterTypeFlags res = MonsterTypeFlags::None;
+		const uint32 cnt = min(SpawnLookahead, numeric_cast<uint32>(definitions.size()));
+		if (cnt == 0)
+			return res;
+		std::nth_element(definitions.begin(), definitions.begin() + (cnt - 1), definitions.end());
+		for (uint32 i = 0; i < cnt; i++)
+			res |= definitions[i].spawnTypes;
+		std::nth_element(definitions.begin(), definitions.begin(), definitions.begin() + cnt);
+		return res;
+	}
+
+	void packsRelease(MonsterTypeFlags keep)
+	{
+		for (const MonsterPack &p : MonsterPacks)
+		{
+			if (any(packsLoaded & p.types) && !any(keep & p.types))
+			{
+				engineAssets()->remove(p.name);
+				packsLoaded &= ~p.types;
+			}
+		}
+	}
+
 	void SpawnDefinition::perform()
 	{
 		spawn();
@@ -109,7 +152,7 @@ namespace
 		CAGE_ASSERT(alSiz > 0);
 		uint32 spawnCount = randomRange(spawnCountMin, spawnCountMax + 1);
 		spawned += spawnCount;
-		vec3 color = colorHsvToRgb(vec3(randomChance(), sqrt(randomChance()) * 0.5 + 0.5, sqrt(randomChance()) * 0.5 + 0.5));
+		vec3 color = colorFromHsv(vec3(randomChance(), sqrt(randomChance()) * 0.5 + 0.5, sqrt(randomChance()) * 0.5 + 0.5));
 		switch (placingPolicy)
 		{
 		case PlacingPolicyEnum::Random:
@@ -145,7 +188,7 @@ namespace
 
 	void engineUpdate()
 	{
-		OPTICK_EVENT("spawning");
+		DEGRID_SYSTEM_TIMING("spawning");
 
 		if (game.paused)
 			return;
@@ -163,7 +206,7 @@ namespace
 			return;
 
 		definitions[0].perform();
-		std::nth_element(definitions.begin(), definitions.begin(), definitions.end());
+		monstersPrefetch(upcomingTypes());
 	}
 
 	void announceJokeMap()
@@ -172,7 +215,7 @@ namespace
 		makeAnnouncement(HashString("announcement/joke-map"), HashString("announcement-desc/joke-map"), 120 * 30);
 	}
 
-	void gameStart()
+	void initializeDefinitions()
 	{
 		definitions.clear();
 		definitions.reserve(30);
@@ -205,7 +248,9 @@ namespace
 		// individually spawned monsters
 		///////////////////////////////////////////////////////////////////////////
 
+#ifndef DEGRID_BENCH
 		monstersSpawnInitial();
+#endif // DEGRID_BENCH
 
 		{ // small monsters individually
 			SpawnDefinition d("individual small monsters");
@@ -505,6 +550,19 @@ namespace
 #endif
 	}
 
+	void gameStart()
+	{
+		initializeDefinitions();
+		const MonsterTypeFlags upcoming = upcomingTypes();
+		packsRelease(upcoming); // monsters of previous game
+		monstersPrefetch(upcoming);
+	}
+
+	void engineFinalize()
+	{
+		packsRelease(MonsterTypeFlags::None);
+	}
+
 	void gameStop()
 	{
 #ifdef DEGRID_TESTING
@@ -515,19 +573,35 @@ namespace
 		}
 #endif // DEGRID_TESTING
 
+		if (Ini *report = gameReport())
+		{
+			for (auto &d : definitions)
+			{
+				const string section = stringizer() + "spawn " + d.name;
+				report->setString(section, "iteration", stringizer() + d.iteration);
+				report->setString(section, "spawned", stringizer() + d.spawned);
+				report->setString(section, "priority", stringizer() + d.priorityCurrent);
+			}
+		}
+
 		definitions.clear();
 	}
 
 	class Callbacks
 	{
+		EventListener<void()> engineFinalizeListener;
 		EventListener<void()> engineUpdateListener;
 		EventListener<void()> gameStartListener;
 		EventListener<void()> gameStopListener;
 	public:
-		Callbacks() : engineUpdateListener("spawning"), gameStartListener("spawning"), gameStopListener("spawning")
+		Callbacks() : engineFinalizeListener("spawning"), engineUpdateListener("spawning"), gameStartListener("spawning"), gameStopListener("spawning")
 		{
+			engineFinalizeListener.attach(controlThread().finalize);
+			engineFinalizeListener.bind<&engineFinalize>();
+#ifndef DEGRID_BENCH // the benchmark spawns the monsters of its scenarios
 			engineUpdateListener.attach(controlThread().update);
 			engineUpdateListener.bind<&engineUpdate>();
+#endif // DEGRID_BENCH
 			gameStartListener.attach(gameStartEvent());
 			gameStartListener.bind<&gameStart>();
 			gameStopListener.attach(gameStopEvent());
@@ -538,6 +612,7 @@ namespace
 
 void spawnGeneral(MonsterTypeFlags type, const vec3 &spawnPosition, const vec3 &color)
 {
+	monstersPrefetch(type); // late, but the monster becomes visible once its assets are loaded
 	switch (type)
 	{
 	case MonsterTypeFlags::Snake: return spawnSnake(spawnPosition, color);
@@ -571,3 +646,32 @@ void monstersSpawnInitial()
 		d.spawn();
 	}
 }
+
+void monstersSpawnDefinition(const string &name, uint32 count)
+{
+	for (const SpawnDefinition &it : definitions)
+	{
+		if (it.name != name)
+			continue;
+		SpawnDefinition d = it;
+		if (count == 0)
+			count = statistics.monstersCurrent < monstersLimit() ? monstersLimit() - statistics.monstersCurrent : 1;
+		d.spawnCountMin = d.spawnCountMax = count;
+		monstersPrefetch(d.spawnTypes);
+		d.spawn();
+		return;
+	}
+	CAGE_THROW_ERROR(Exception, "unknown spawn definition");
+}
+
+void monstersPrefetch(MonsterTypeFlags types)
+{
+	for (const MonsterPack &p : MonsterPacks)
+	{
+		if (any(types & p.types) && !any(packsLoaded & p.types))
+		{
+			engineAssets()->add(p.name);
+			packsLoaded |= p.types;
+		}
+	}
+}
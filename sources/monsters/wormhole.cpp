@@ -24,6 +24,8 @@ namespace
 	EntityComponent *WormholeComponent::component;
 	EntityComponent *MonsterFlickeringComponent::component;
 
+	std::vector<vec3> flickeringColors;
+
 	void countWormholes(uint32 &positive, uint32 &negative)
 	{
 		positive = negative = 0;
@@ -96,21 +98,43 @@ namespace
 	void engineInit()
 	{
 		WormholeComponent::component = engineEntities()->defineComponent(WormholeComponent());
+		DEGRID_MEMORY_COMPONENT(Wormhole);
 		MonsterFlickeringComponent::component = engineEntities()->defineComponent(MonsterFlickeringComponent());
+		DEGRID_MEMORY_COMPONENT(MonsterFlickering);
+	}
+
+	vec3 teleportDestination(const vec3 &playerPosition)
+	{
+		rads angle = randomAngle();
+		vec3 dir = vec3(cos(angle), 0, sin(angle));
+		Entity *target = pickWormhole(-1);
+		if (target)
+		{
+			CAGE_COMPONENT_ENGINE(Transform, tt, target);
+			return tt.position + dir * tt.scale;
+		}
+		return playerPosition + dir * randomRange(200, 250);
 	}
 
 	void engineUpdate()
 	{
-		OPTICK_EVENT("wormhole");
+		DEGRID_SYSTEM_TIMING("wormhole");
 
 		{ // flickering
+			flickeringColors.clear();
 			for (Entity *e : MonsterFlickeringComponent::component->entities())
 			{
-				CAGE_COMPONENT_ENGINE(Render, r, e);
 				DEGRID_COMPONENT(MonsterFlickering, m, e);
 				real l = (real)engineControlTime() * m.flickeringFrequency + m.flickeringOffset;
 				real s = sin(rads::Full() * l) * 0.5 + 0.5;
-				r.color = colorHsvToRgb(vec3(m.baseColorHsv[0], s, m.baseColorHsv[2]));
+				flickeringColors.push_back(vec3(m.baseColorHsv[0], s, m.baseColorHsv[2]));
+			}
+			colorsFromHsv({ flickeringColors.data(), flickeringColors.data() + flickeringColors.size() });
+			uint32 i = 0;
+			for (Entity *e : MonsterFlickeringComponent::component->entities())
+			{
+				CAGE_COMPONENT_ENGINE(Render, r, e);
+				r.color = flickeringColors[i++];
 			}
 		}
 
@@ -137,8 +161,7 @@ namespace
 			if (g.strength > 0)
 			{ // this is sucking wormhole
 				CAGE_COMPONENT_ENGINE(Transform, playerTransform, game.playerEntity);
-				spatialSearchQuery->intersection(Sphere(t.position, t.scale + 0.1));
-				for (uint32 otherName : spatialSearchQuery->result())
+				for (uint32 otherName : spatialQuery(SpatialSiteEnum::Wormhole, Sphere(t.position, t.scale + 0.1)))
 				{
 					if (otherName == myName)
 						continue;
@@ -151,6 +174,7 @@ namespace
 					// shots
 					if (oe->has(ShotComponent::component))
 						continue;
+					spatialQueryUsed(SpatialSiteEnum::Wormhole);
 
 					bool teleport = false;
 
@@ -167,10 +191,6 @@ namespace
 							continue;
 					}
 
-					// grids
-					if (oe->has(GridComponent::component))
-						teleport = true;
-
 					// monsters
 					if (oe->has(MonsterComponent::component))
 					{
@@ -181,21 +201,16 @@ namespace
 					if (teleport)
 					{
 						CAGE_COMPONENT_ENGINE(Transform, ot, oe);
-						rads angle = randomAngle();
-						vec3 dir = vec3(cos(angle), 0, sin(angle));
-						Entity *target = pickWormhole(-1);
-						if (target)
-						{
-							CAGE_COMPONENT_ENGINE(Transform, tt, target);
-							ot.position = tt.position + dir * tt.scale;
-						}
-						else
-							ot.position = playerTransform.position + dir * randomRange(200, 250);
+						ot.position = teleportDestination(playerTransform.position);
 						oe->remove(TransformComponent::componentHistory);
 					}
 					else
 						oe->add(entitiesToDestroy);
 				}
+
+				// grids
+				for (uint32 i : gridMarkersQuery(t.position, t.scale + 0.1))
+					gridMarkerTeleport(i, teleportDestination(playerTransform.position));
 			}
 			else
 			{ // this is pushing wormhole
@@ -252,6 +267,6 @@ void spawnWormhole(const vec3 &spawnPosition, const vec3 &color)
 	DEGRID_COMPONENT(Rotation, rotation, wormhole);
 	rotation.rotation = interpolate(quat(), randomDirectionQuat(), 0.01);
 	monsterReflectMutation(wormhole, special);
-	soundEffect(HashString("degrid/monster/wormhole.ogg"), spawnPosition);
+	soundEffect(HashString("degrid/monster/wormhole.ogg"), spawnPosition, SoundPriorityEnum::Monster);
 }
 
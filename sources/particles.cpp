@@ -0,0 +1,232 @@
+#include <cage-core/entities.h>
+#include <cage-core/hashString.h>
+
+#include "game.h"
+
+#include <vector>
+
+namespace
+{
+	struct Particle
+	{
+		quat orientation;
+		vec3 position;
+		vec3 velocity;
+		vec3 color;
+		real scale;
+		uint64 startTime = 0;
+		uint32 ttl = 0;
+		uint32 duration = 0;
+		ParticleEmitterEnum emitter = ParticleEmitterEnum::Total;
+		bool moved = true; // the render entity must not interpolate from its previous particle
+	};
+
+	struct ParticlePool
+	{
+		std::vector<Particle> particles; // alive particles only
+		std::vector<Entity *> entities; // render entities, matching the particles by index
+		uint32 rendered = 0; // number of entities that currently have render component
+		uint32 object = 0;
+		bool colored = false;
+		bool animated = false;
+	};
+
+	enum class ParticleEffectEnum : uint32
+	{
+		Debris,
+		Spark,
+		Total
+	};
+
+	constexpr ParticleEffectEnum EmitterEffect[(uint32)ParticleEmitterEnum::Total] = {
+		ParticleEffectEnum::Debris, // explosion
+		ParticleEffectEnum::Spark, // ship
+		ParticleEffectEnum::Spark, // rocket
+	};
+	constexpr uint32 EmitterBudget[(uint32)ParticleEmitterEnum::Total] = {
+		2000, // explosion
+		100, // ship
+		400, // rocket
+	};
+
+	ParticlePool pools[(uint32)ParticleEffectEnum::Total];
+	uint32 emitterCounts[(uint32)ParticleEmitterEnum::Total];
+
+	void engineInit()
+	{
+		{
+			ParticlePool &p = pools[(uint32)ParticleEffectEnum::Debris];
+			p.object = HashString("degrid/environment/explosion.object");
+			p.colored = true;
+		}
+		{
+			ParticlePool &p = pools[(uint32)ParticleEffectEnum::Spark];
+			p.object = HashString("degrid/environment/spark.object");
+			p.animated = true;
+		}
+	}
+
+	void integrate(ParticlePool &pool)
+	{
+		std::vector<Particle> &ps = pool.particles;
+
+		if (!game.paused)
+		{ // gravity
+			for (Entity *e : GravityComponent::component->entities())
+			{
+				CAGE_COMPONENT_ENGINE(Transform, t, e);
+				DEGRID_COMPONENT(Gravity, g, e);
+				for (Particle &p : ps)
+				{
+					vec3 d = t.position - p.position;
+					if (lengthSquared(d) < 1e-3)
+						continue;
+					p.position += normalize(d) * (g.strength / max(length(d) - t.scale, 1));
+				}
+			}
+		}
+
+		// velocity
+		for (Particle &p : ps)
+			p.position += p.velocity;
+
+		// timeout
+		uint32 i = 0;
+		while (i < ps.size())
+		{
+			Particle &p = ps[i];
+			if (p.ttl == 0)
+			{
+				emitterCounts[(uint32)p.emitter]--;
+				p = ps.back();
+				p.moved = true;
+				ps.pop_back();
+			}
+			else
+			{
+				p.ttl--;
+				i++;
+			}
+		}
+	}
+
+	void render(ParticlePool &pool)
+	{
+		const uint32 cnt = numeric_cast<uint32>(pool.particles.size());
+		while (pool.entities.size() < cnt)
+			pool.entities.push_back(engineEntities()->createAnonymous());
+		for (uint32 i = 0; i < cnt; i++)
+		{
+			Particle &p = pool.particles[i];
+			Entity *e = pool.entities[i];
+			CAGE_COMPONENT_ENGINE(Transform, t, e);
+			t.position = p.position;
+			t.orientation = p.orientation;
+			t.scale = p.scale;
+			if (p.moved)
+			{
+				e->remove(TransformComponent::componentHistory);
+				p.moved = false;
+			}
+			CAGE_COMPONENT_ENGINE(Render, r, e);
+			r.object = pool.object;
+			if (pool.colored)
+				r.color = p.color;
+			if (pool.animated)
+			{
+				CAGE_COMPONENT_ENGINE(TextureAnimation, at, e);
+				at.startTime = p.startTime;
+				at.speed = 30.f / p.duration;
+			}
+		}
+		for (uint32 i = cnt; i < pool.rendered; i++)
+			pool.entities[i]->remove(RenderComponent::component);
+		pool.rendered = cnt;
+	}
+
+	void engineUpdate()
+	{
+		DEGRID_SYSTEM_TIMING("particles");
+
+		uint32 total = 0;
+		for (ParticlePool &pool : pools)
+		{
+			integrate(pool);
+			render(pool);
+			total += numeric_cast<uint32>(pool.particles.size());
+		}
+		statistics.particlesCurrent = total;
+		statistics.particlesMax = max(statistics.particlesMax, total);
+	}
+
+	void gameStart()
+	{
+		// the render entities are destroyed with all other entities
+		for (ParticlePool &pool : pools)
+		{
+			pool.particles.clear();
+			pool.entities.clear();
+			pool.rendered = 0;
+		}
+		for (uint32 &it : emitterCounts)
+			it = 0;
+	}
+
+	Particle *particleAdd(ParticleEmitterEnum emitter)
+	{
+		CAGE_ASSERT(emitter < ParticleEmitterEnum::Total);
+		if (emitterCounts[(uint32)emitter] >= EmitterBudget[(uint32)emitter])
+		{
+			statistics.particlesDropped++;
+			return nullptr;
+		}
+		emitterCounts[(uint32)emitter]++;
+		ParticlePool &pool = pools[(uint32)EmitterEffect[(uint32)emitter]];
+		pool.particles.emplace_back();
+		Particle *p = &pool.particles.back();
+		p->emitter = emitter;
+		p->orientation = randomDirectionQuat();
+		return p;
+	}
+
+	class Callbacks
+	{
+		EventListener<void()> engineInitListener;
+		EventListener<void()> engineUpdateListener;
+		EventListener<void()> gameStartListener;
+	public:
+		Callbacks() : engineInitListener("particles"), engineUpdateListener("particles"), gameStartListener("particles")
+		{
+			engineInitListener.attach(controlThread().initialize);
+			engineInitListener.bind<&engineInit>();
+			engineUpdateListener.attach(controlThread().update, 32); // after physics
+			engineUpdateListener.bind<&engineUpdate>();
+			gameStartListener.attach(gameStartEvent());
+			gameStartListener.bind<&gameStart>();
+		}
+	} callbacksInstance;
+}
+
+void particleDebris(const vec3 &position, const vec3 &velocity, real scale, const vec3 &color, uint32 ttl)
+{
+	Particle *p = particleAdd(ParticleEmitterEnum::Explosion);
+	if (!p)
+		return;
+	p->position = position;
+	p->velocity = velocity;
+	p->scale = scale;
+	p->color = color;
+	p->ttl = p->duration = ttl;
+}
+
+void particleSpark(ParticleEmitterEnum emitter, const vec3 &position, const vec3 &velocity, real scale, uint32 ttl)
+{
+	Particle *p = particleAdd(emitter);
+	if (!p)
+		return;
+	p->position = position;
+	p->velocity = velocity;
+	p->scale = scale;
+	p->ttl = p->duration = ttl;
+	p->startTime = engineControlTime();
+}
@@ -21,7 +21,7 @@ namespace
 
 	void engineUpdate()
 	{
-		OPTICK_EVENT("physics");
+		DEGRID_SYSTEM_TIMING("physics");
 
 		if (!game.paused)
 		{ // gravity
@@ -89,6 +89,7 @@ namespace
 		{
 			OPTICK_EVENT("Spatial update");
 			spatialSearchData->clear();
+			uint32 items = 0;
 			for (Entity *e : TransformComponent::component->entities())
 			{
 				uint32 n = e->name();
@@ -96,8 +97,10 @@ namespace
 				{
 					CAGE_COMPONENT_ENGINE(Transform, tr, e);
 					spatialSearchData->update(n, Sphere(tr.position, tr.scale));
+					items++;
 				}
 			}
+			statistics.spatialItemsCurrent = items;
 		}
 
 		{
@@ -128,3 +131,23 @@ bool collisionTest(const vec3 &positionA, real radiusA, const vec3 &velocityA, c
 		return intersects(makeSegment(positionB, positionB + m), Sphere(positionA, radiusA + radiusB));
 	return intersects(positionB, Sphere(positionA, radiusA + radiusB));
 }
+
+PointerRange<const uint32> spatialQuery(SpatialSiteEnum site, const Sphere &sphere)
+{
+	CAGE_ASSERT(site < SpatialSiteEnum::Total);
+	spatialSearchQuery->intersection(sphere);
+	const auto res = spatialSearchQuery->result();
+	const uint32 cnt = numeric_cast<uint32>(res.size());
+	statistics.spatialQueries[(uint32)site]++;
+	statistics.spatialQueriesCurrent[(uint32)site]++;
+	statistics.spatialResults[(uint32)site] += cnt;
+	statistics.spatialResultsCurrent[(uint32)site] += cnt;
+	return { res.begin(), res.end() };
+}
+
+void spatialQueryUsed(SpatialSiteEnum site)
+{
+	CAGE_ASSERT(site < SpatialSiteEnum::Total);
+	statistics.spatialUsed[(uint32)site]++;
+	statistics.spatialUsedCurrent[(uint32)site]++;
+}
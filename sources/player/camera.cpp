@@ -22,7 +22,7 @@ namespace
 
 	void engineUpdate()
 	{
-		OPTICK_EVENT("camera");
+		DEGRID_SYSTEM_TIMING("camera");
 
 		if (game.gameOver)
 			return;
@@ -174,7 +174,7 @@ namespace
 
 	void engineUpdate()
 	{
-		OPTICK_EVENT("controls");
+		DEGRID_SYSTEM_TIMING("controls");
 		CAGE_ASSERT(!game.gameOver || game.paused);
 
 		if (game.paused)
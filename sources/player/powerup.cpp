@@ -1,6 +1,5 @@
 #include <cage-core/entities.h>
 #include <cage-core/config.h>
-#include <cage-core/color.h>
 #include <cage-core/hashString.h>
 
 #include "../game.h"
@@ -70,7 +69,7 @@ namespace
 	{
 		statistics.powerupsWasted++;
 		game.money += PowerupSellPriceBase * (game.defeatedBosses + 1);
-		soundSpeech(HashString("degrid/speech/pickup/sold.wav"));
+		soundSpeech(HashString("degrid/speech/pickup/sold.wav"), SpeechCategoryEnum::Pickup);
 	}
 
 	void powerupsUpdate()
@@ -102,9 +101,9 @@ namespace
 					game.powerups[(uint32)p.type]++;
 					switch (p.type)
 					{
-					case PowerupTypeEnum::Bomb: soundSpeech(HashString("degrid/speech/pickup/a-bomb.wav")); break;
-					case PowerupTypeEnum::Decoy: soundSpeech(HashString("degrid/speech/pickup/a-decoy.wav")); break;
-					case PowerupTypeEnum::Turret: soundSpeech(HashString("degrid/speech/pickup/a-turret.wav")); break;
+					case PowerupTypeEnum::Bomb: soundSpeech(HashString("degrid/speech/pickup/a-bomb.wav"), SpeechCategoryEnum::Pickup); break;
+					case PowerupTypeEnum::Decoy: soundSpeech(HashString("degrid/speech/pickup/a-decoy.wav"), SpeechCategoryEnum::Pickup); break;
+					case PowerupTypeEnum::Turret: soundSpeech(HashString("degrid/speech/pickup/a-turret.wav"), SpeechCategoryEnum::Pickup); break;
 					default: CAGE_THROW_CRITICAL(Exception, "invalid powerup type");
 					}
 					{ // achievement
@@ -127,9 +126,9 @@ namespace
 				game.powerups[(uint32)p.type] += duration;
 				switch (p.type)
 				{
-				case PowerupTypeEnum::Shield: soundSpeech(HashString("degrid/speech/pickup/shield-engaged.wav")); break;
-				case PowerupTypeEnum::HomingShots: soundSpeech(HashString("degrid/speech/pickup/homing-missiles.wav")); break;
-				case PowerupTypeEnum::SuperDamage: soundSpeech(HashString("degrid/speech/pickup/super-damage.wav")); break;
+				case PowerupTypeEnum::Shield: soundSpeech(HashString("degrid/speech/pickup/shield-engaged.wav"), SpeechCategoryEnum::Pickup); break;
+				case PowerupTypeEnum::HomingShots: soundSpeech(HashString("degrid/speech/pickup/homing-missiles.wav"), SpeechCategoryEnum::Pickup); break;
+				case PowerupTypeEnum::SuperDamage: soundSpeech(HashString("degrid/speech/pickup/super-damage.wav"), SpeechCategoryEnum::Pickup); break;
 				default: CAGE_THROW_CRITICAL(Exception, "invalid powerup type");
 				}
 				if (game.powerups[(uint32)p.type] > 2 * duration)
@@ -142,14 +141,14 @@ namespace
 					game.powerups[(uint32)p.type]++;
 					switch (p.type)
 					{
-					case PowerupTypeEnum::Acceleration: soundSpeech(HashString("degrid/speech/pickup/acceleration-improved.wav")); break;
-					case PowerupTypeEnum::MaxSpeed: soundSpeech(HashString("degrid/speech/pickup/movement-speed-improved.wav")); break;
-					case PowerupTypeEnum::Multishot: soundSpeech(HashString("degrid/speech/pickup/additional-cannon.wav")); break;
-					case PowerupTypeEnum::ShotsSpeed: soundSpeech(HashString("degrid/speech/pickup/missiles-speed-improved.wav")); break;
-					case PowerupTypeEnum::ShotsDamage: soundSpeech(HashString("degrid/speech/pickup/missiles-damage-improved.wav")); break;
-					case PowerupTypeEnum::FiringSpeed: soundSpeech(HashString("degrid/speech/pickup/firing-speed-improved.wav")); break;
-					case PowerupTypeEnum::Armor: soundSpeech(HashString("degrid/speech/pickup/improved-armor.wav")); break;
-					case PowerupTypeEnum::Duration: soundSpeech(HashString("degrid/speech/pickup/increased-powerup-duration.wav")); break;
+					case PowerupTypeEnum::Acceleration: soundSpeech(HashString("degrid/speech/pickup/acceleration-improved.wav"), SpeechCategoryEnum::Pickup); break;
+					case PowerupTypeEnum::MaxSpeed: soundSpeech(HashString("degrid/speech/pickup/movement-speed-improved.wav"), SpeechCategoryEnum::Pickup); break;
+					case PowerupTypeEnum::Multishot: soundSpeech(HashString("degrid/speech/pickup/additional-cannon.wav"), SpeechCategoryEnum::Pickup); break;
+					case PowerupTypeEnum::ShotsSpeed: soundSpeech(HashString("degrid/speech/pickup/missiles-speed-improved.wav"), SpeechCategoryEnum::Pickup); break;
+					case PowerupTypeEnum::ShotsDamage: soundSpeech(HashString("degrid/speech/pickup/missiles-damage-improved.wav"), SpeechCategoryEnum::Pickup); break;
+					case PowerupTypeEnum::FiringSpeed: soundSpeech(HashString("degrid/speech/pickup/firing-speed-improved.wav"), SpeechCategoryEnum::Pickup); break;
+					case PowerupTypeEnum::Armor: soundSpeech(HashString("degrid/speech/pickup/improved-armor.wav"), SpeechCategoryEnum::Pickup); break;
+					case PowerupTypeEnum::Duration: soundSpeech(HashString("degrid/speech/pickup/increased-powerup-duration.wav"), SpeechCategoryEnum::Pickup); break;
 					default: CAGE_THROW_CRITICAL(Exception, "invalid powerup type");
 					}
 				}
@@ -160,7 +159,7 @@ namespace
 			{
 				game.powerups[(uint32)p.type]++; // count the coins (for statistics & achievement)
 				game.money += game.defeatedBosses + 1;
-				soundSpeech(HashString("degrid/speech/pickup/a-coin.wav"));
+				soundSpeech(HashString("degrid/speech/pickup/a-coin.wav"), SpeechCategoryEnum::Pickup);
 				if (game.powerups[(uint32)p.type] == 1000)
 					achievementFullfilled("vault-digger");
 			} break;
@@ -173,12 +172,14 @@ namespace
 	void engineInit()
 	{
 		TurretComponent::component = engineEntities()->defineComponent(TurretComponent());
+		DEGRID_MEMORY_COMPONENT(Turret);
 		DecoyComponent::component = engineEntities()->defineComponent(DecoyComponent());
+		DEGRID_MEMORY_COMPONENT(Decoy);
 	}
 
 	void engineUpdate()
 	{
-		OPTICK_EVENT("powerups");
+		DEGRID_SYSTEM_TIMING("powerups");
 
 		if (game.paused)
 			return;
@@ -262,8 +263,8 @@ void powerupSpawn(const vec3 &position)
 		HashString("degrid/player/coin.object")
 	};
 	render.object = ObjectName[PowerupMode[(uint32)p.type]];
-	render.color = colorHsvToRgb(vec3(randomChance(), 1, 1));
-	soundEffect(coin ? HashString("degrid/player/coin.ogg") : HashString("degrid/player/powerup.ogg"), transform.position);
+	render.color = colorFromHsv(vec3(randomChance(), 1, 1));
+	soundEffect(coin ? HashString("degrid/player/coin.ogg") : HashString("degrid/player/powerup.ogg"), transform.position, SoundPriorityEnum::Pickup);
 }
 
 void eventBomb()
@@ -293,11 +294,7 @@ void eventBomb()
 
 	{
 		CAGE_COMPONENT_ENGINE(Transform, playerTransform, game.playerEntity);
-		for (Entity *e : GridComponent::component->entities())
-		{
-			CAGE_COMPONENT_ENGINE(Transform, t, e);
-			t.position = playerTransform.position + randomDirection3() * vec3(100, 1, 100);
-		}
+		gridMarkersScatter(playerTransform.position, vec3(100, 1, 100));
 	}
 
 	if (BossComponent::component->group()->count() == 0)
@@ -308,7 +305,7 @@ void eventBomb()
 		HashString("degrid/speech/use/burn-them-all.wav"),
 		HashString("degrid/speech/use/let-them-burn.wav"),
 		0 };
-	soundSpeech(Sounds);
+	soundSpeech(Sounds, SpeechCategoryEnum::Pickup);
 
 	if (kills == 0)
 		achievementFullfilled("wasted");
@@ -341,7 +338,7 @@ void eventTurret()
 		HashString("degrid/speech/use/engaging-a-turret.wav"),
 		HashString("degrid/speech/use/turret-engaged.wav"),
 		0 };
-	soundSpeech(Sounds);
+	soundSpeech(Sounds, SpeechCategoryEnum::Pickup);
 
 	if (TurretComponent::component->group()->count() >= 4)
 		achievementFullfilled("turrets");
@@ -373,7 +370,7 @@ void eventDecoy()
 		HashString("degrid/speech/use/decoy-launched.wav"),
 		HashString("degrid/speech/use/launching-a-decoy.wav"),
 		0 };
-	soundSpeech(Sounds);
+	soundSpeech(Sounds, SpeechCategoryEnum::Pickup);
 }
 
 uint32 permanentPowerupLimit()
@@ -32,32 +32,20 @@ namespace
 				vl.velocity += change;
 			if (lengthSquared(vl.velocity) > sqr(maxSpeed))
 				vl.velocity = normalize(vl.velocity) * maxSpeed;
-			if (lengthSquared(change) > 0.01)
+			if (lengthSquared(change) > 0.01 && randomChance() < qualityScale())
 			{
-				Entity *spark = engineEntities()->createAnonymous();
-				CAGE_COMPONENT_ENGINE(Transform, transform, spark);
-				transform.scale = randomChance() * 0.2 + 0.3;
-				transform.position = tr.position + tr.orientation * vec3((sint32)(statistics.updateIterationIgnorePause % 2) * 1.2 - 0.6, 0, 1) * tr.scale;
-				transform.orientation = randomDirectionQuat();
-				CAGE_COMPONENT_ENGINE(Render, render, spark);
-				render.object = HashString("degrid/environment/spark.object");
-				DEGRID_COMPONENT(Velocity, vel, spark);
-				vel.velocity = (change + randomDirection3() * 0.05) * randomChance() * -5;
-				DEGRID_COMPONENT(Timeout, ttl, spark);
-				ttl.ttl = randomRange(10, 15);
-				CAGE_COMPONENT_ENGINE(TextureAnimation, at, spark);
-				at.startTime = engineControlTime();
-				at.speed = 30.f / ttl.ttl;
-				spark->add(entitiesPhysicsEvenWhenPaused);
+				vec3 pos = tr.position + tr.orientation * vec3((sint32)(statistics.updateIterationIgnorePause % 2) * 1.2 - 0.6, 0, 1) * tr.scale;
+				particleSpark(ParticleEmitterEnum::Ship, pos, (change + randomDirection3() * 0.05) * randomChance() * -5, randomChance() * 0.2 + 0.3, randomRange(10, 15));
 			}
 		}
 		else
 			vl.velocity *= 0.97;
 
 		// pull to center
-		if (length(tr.position) > MapNoPullRadius)
+		const real radius = mapNoPullRadius();
+		if (length(tr.position) > radius)
 		{
-			vec3 pullToCenter = -normalize(tr.position) * pow((length(tr.position) - MapNoPullRadius) * 0.02, 2);
+			vec3 pullToCenter = -normalize(tr.position) * pow((length(tr.position) - radius) * 0.02, 2);
 			vl.velocity += pullToCenter;
 		}
 
@@ -70,6 +58,8 @@ namespace
 
 	void shipShield()
 	{
+		DEGRID_SYSTEM_TIMING("ship shield");
+
 		if (!game.playerEntity || !game.shieldEntity)
 			return;
 		CAGE_COMPONENT_ENGINE(Transform, tr, game.playerEntity);
@@ -130,13 +120,13 @@ namespace
 				HashString("degrid/speech/progress/they-say-the-princess-is-very-beautiful.wav"),
 				0
 			};
-			soundSpeech(Sounds);
+			soundSpeech(Sounds, SpeechCategoryEnum::Progress);
 		}
 	}
 
 	void engineUpdate()
 	{
-		OPTICK_EVENT("ship");
+		DEGRID_SYSTEM_TIMING("ship");
 
 		if (!game.paused)
 		{
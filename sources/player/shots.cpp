@@ -2,7 +2,6 @@
 #include <cage-core/config.h>
 #include <cage-core/entities.h>
 #include <cage-core/spatialStructure.h>
-#include <cage-core/color.h>
 #include <cage-core/hashString.h>
 
 #include "../game.h"
@@ -41,7 +40,7 @@ namespace
 			CAGE_COMPONENT_ENGINE(Render, render, shot);
 			render.object = HashString("degrid/player/shot.object");
 			if (game.powerups[(uint32)PowerupTypeEnum::SuperDamage] > 0)
-				render.color = colorHsvToRgb(vec3(randomChance(), 1, 1));
+				render.color = colorFromHsv(vec3(randomChance(), 1, 1));
 			else
 				render.color = game.shotsColor;
 			DEGRID_COMPONENT(Velocity, vel, shot);
@@ -69,8 +68,14 @@ namespace
 			DEGRID_COMPONENT(Shot, sh, e);
 			DEGRID_COMPONENT(Velocity, vl, e);
 
-			spatialSearchQuery->intersection(Sphere(tr.position, length(vl.velocity) + tr.scale + (sh.homing ? 20 : 10)));
-			for (uint32 otherName : spatialSearchQuery->result())
+			const real searchRadius = length(vl.velocity) + tr.scale + (sh.homing ? 20 : 10);
+			for (uint32 i : gridMarkersQuery(tr.position, searchRadius))
+			{
+				vec3 toOther = gridMarkerPosition(i) - tr.position;
+				gridMarkerImpulse(i, normalize(vl.velocity) * (0.2f / max(1, length(toOther))), vec3());
+			}
+
+			for (uint32 otherName : spatialQuery(SpatialSiteEnum::Shots, Sphere(tr.position, searchRadius)))
 			{
 				if (otherName == myName)
 					continue;
@@ -78,14 +83,9 @@ namespace
 				Entity *e = engineEntities()->get(otherName);
 				CAGE_COMPONENT_ENGINE(Transform, ot, e);
 				vec3 toOther = ot.position - tr.position;
-				if (e->has(GridComponent::component))
-				{
-					DEGRID_COMPONENT(Velocity, og, e);
-					og.velocity += normalize(vl.velocity) * (0.2f / max(1, length(toOther)));
-					continue;
-				}
 				if (!e->has(MonsterComponent::component))
 					continue;
+				spatialQueryUsed(SpatialSiteEnum::Shots);
 				DEGRID_COMPONENT(Monster, om, e);
 				if (om.life <= 0)
 					continue;
@@ -163,7 +163,7 @@ namespace
 
 	void engineUpdate()
 	{
-		OPTICK_EVENT("shots");
+		DEGRID_SYSTEM_TIMING("shots");
 
 		if (!game.paused)
 		{
@@ -174,7 +174,7 @@ namespace
 
 	void gameStart()
 	{
-		game.shotsColor = game.cinematic ? colorHsvToRgb(vec3(randomChance(), 1, 1)) : vec3((float)confPlayerShotColorR, (float)confPlayerShotColorG, (float)confPlayerShotColorB);
+		game.shotsColor = game.cinematic ? colorFromHsv(vec3(randomChance(), 1, 1)) : vec3((float)confPlayerShotColorR, (float)confPlayerShotColorG, (float)confPlayerShotColorB);
 	}
 
 	class Callbacks
@@ -0,0 +1,98 @@
+#include <cage-core/config.h>
+
+#include "game.h"
+
+namespace
+{
+	ConfigBool confQualityAdaptive("degrid/quality/adaptive", true);
+	ConfigUint32 confQualityRenderBudget("degrid/quality/renderBudget", 16667); // us
+	ConfigUint32 confQualityUpdateBudget("degrid/quality/updateBudget", 25000); // us
+
+	constexpr uint32 QualityLevels = 4;
+	constexpr const float QualityScales[QualityLevels] = { 1, 0.7f, 0.45f, 0.25f };
+	constexpr uint32 QualityCooldown = 60; // ticks between changes
+	constexpr uint32 QualityRecovery = 150; // ticks of low load required to raise the quality
+
+	uint32 level = 0;
+	uint32 lastChange = 0;
+	uint32 lowLoadTicks = 0;
+	real smoothRender;
+	real smoothUpdate;
+
+	void changeLevel(uint32 l)
+	{
+		CAGE_ASSERT(l < QualityLevels);
+		level = l;
+		lastChange = statistics.updateIterationIgnorePause;
+		lowLoadTicks = 0;
+		statistics.qualityLevel = level;
+		statistics.qualityLevelMax = max(statistics.qualityLevelMax, level);
+		statistics.qualityChanges++;
+		CAGE_LOG(SeverityEnum::Info, "quality", stringizer() + "cosmetic quality level: " + level + ", render: " + smoothRender + " us, update: " + smoothUpdate + " us");
+	}
+
+	void engineUpdate()
+	{
+		DEGRID_SYSTEM_TIMING("quality");
+
+		if (!confQualityAdaptive)
+		{
+			if (level != 0)
+				changeLevel(0);
+			return;
+		}
+
+		// frame time includes waiting for vsync, which would prevent the recovery
+		smoothRender = interpolate(smoothRender, real(statistics.timeRenderCostCurrent), 0.05);
+		smoothUpdate = interpolate(smoothUpdate, real(statistics.timeUpdateCurrent), 0.05);
+
+		if (statistics.updateIterationIgnorePause < lastChange + QualityCooldown)
+			return;
+
+		const real render = smoothRender / (uint32)confQualityRenderBudget;
+		const real update = smoothUpdate / (uint32)confQualityUpdateBudget;
+		if (render > 1.1 || update > 1.1)
+		{
+			if (level + 1 < QualityLevels)
+				changeLevel(level + 1);
+		}
+		else if (render < 0.7 && update < 0.7)
+		{
+			if (level > 0 && ++lowLoadTicks >= QualityRecovery)
+				changeLevel(level - 1);
+		}
+		else
+			lowLoadTicks = 0;
+	}
+
+	void gameStart()
+	{
+		lastChange = 0;
+		lowLoadTicks = 0;
+		statistics.qualityLevel = statistics.qualityLevelMax = level; // statistics were just reset
+	}
+
+	class Callbacks
+	{
+		EventListener<void()> engineUpdateListener;
+		EventListener<void()> gameStartListener;
+	public:
+		Callbacks() : engineUpdateListener("quality"), gameStartListener("quality")
+		{
+			engineUpdateListener.attach(controlThread().update, -55); // after statistics
+			engineUpdateListener.bind<&engineUpdate>();
+			gameStartListener.attach(gameStartEvent(), -55); // after statistics
+			gameStartListener.bind<&gameStart>();
+		}
+	} callbacksInstance;
+}
+
+uint32 qualityLevel()
+{
+	return level;
+}
+
+real qualityScale()
+{
+	return QualityScales[level];
+}
@@ -670,7 +670,7 @@ namespace
 
 	void engineUpdate()
 	{
-		OPTICK_EVENT("gui");
+		DEGRID_SYSTEM_TIMING("gui");
 
 		if (game.gameOver || game.cinematic)
 			return;
@@ -0,0 +1,184 @@
+#include <cage-core/entities.h>
+#include <cage-core/config.h>
+
+#include "screens.h"
+#include "../game.h"
+
+#include <vector>
+#include <algorithm>
+
+extern ConfigUint32 confLightsBudget;
+extern ConfigUint32 confVoicesBudget;
+
+namespace
+{
+	ConfigBool confOverlayEnabled("degrid/overlay/enabled", false);
+
+	constexpr uint32 OverlayNames = 10000; // gui entity names reserved for the overlay, the first one is its root
+	constexpr uint32 OverlayRefresh = 10; // ticks
+	constexpr const char *SpatialSiteShortName[(uint32)SpatialSiteEnum::Total] = { "dispersion", "avoidance", "shielder", "wormhole", "shots" };
+
+	uint32 namesUsed = 0;
+
+	struct SystemLoad
+	{
+		const char *name = nullptr;
+		uint64 p50 = 0;
+		uint64 p95 = 0;
+	};
+
+	std::vector<SystemLoad> systems;
+
+	void clear()
+	{
+		EntityManager *ents = engineGui()->entities();
+		for (uint32 n = OverlayNames; n < OverlayNames + namesUsed; n++)
+			if (ents->has(n))
+				ents->get(n)->destroy();
+		namesUsed = 0;
+	}
+
+	Entity *create(uint32 parent, uint32 &order)
+	{
+		Entity *e = engineGui()->entities()->create(OverlayNames + namesUsed++);
+		CAGE_COMPONENT_GUI(Parent, p, e);
+		p.parent = parent;
+		p.order = order++;
+		return e;
+	}
+
+	uint32 createRoot()
+	{
+		// separate from the layout panels so that it does not mix with their controls
+		Entity *e = engineGui()->entities()->create(OverlayNames + namesUsed++);
+		CAGE_COMPONENT_GUI(Scrollbars, sc, e);
+		sc.alignment = vec2(1, 0.5);
+		uint32 order = 0;
+		Entity *l = create(e->name(), order);
+		CAGE_COMPONENT_GUI(LayoutLine, ll, l);
+		ll.vertical = true;
+		return l->name();
+	}
+
+	uint32 section(uint32 root, uint32 &order, const string &caption)
+	{
+		Entity *e = create(root, order);
+		CAGE_COMPONENT_GUI(Panel, panel, e);
+		CAGE_COMPONENT_GUI(Text, text, e);
+		text.value = caption;
+		CAGE_COMPONENT_GUI(LayoutTable, layout, e);
+		return e->name();
+	}
+
+	void label(uint32 table, uint32 &order, const string &value)
+	{
+		Entity *e = create(table, order);
+		CAGE_COMPONENT_GUI(Label, control, e);
+		CAGE_COMPONENT_GUI(Text, text, e);
+		text.value = value;
+	}
+
+	void bar(uint32 table, uint32 &order, real progress)
+	{
+		Entity *e = create(table, order);
+		CAGE_COMPONENT_GUI(ProgressBar, pb, e);
+		pb.progress = saturate(progress);
+	}
+
+	void row(uint32 table, uint32 &order, const string &name, const string &value)
+	{
+		label(table, order, name);
+		label(table, order, value);
+	}
+
+	void generate()
+	{
+		uint32 order = 0;
+		const uint32 root = createRoot();
+
+		{ // systems, sorted by their median share of the update period
+			systems.clear();
+			for (uint32 i = 0; i < systemTimingCount(); i++)
+			{
+				const SystemTimingPercentiles p = systemTimingPercentiles(i);
+				if (p.samples == 0)
+					continue;
+				SystemLoad s;
+				s.name = systemTimingName(i);
+				s.p50 = p.p50;
+				s.p95 = p.p95;
+				systems.push_back(s);
+			}
+			std::sort(systems.begin(), systems.end(), [](const SystemLoad &a, const SystemLoad &b) {
+				return a.p50 > b.p50;
+			});
+			const real period = real(controlThread().updatePeriod());
+			uint32 o = 0;
+			const uint32 table = section(root, order, stringizer() + "update: " + statistics.timeUpdateCurrent + " us, render: " + statistics.timeRenderCurrent + " us");
+			real total = 0;
+			for (const SystemLoad &s : systems)
+			{
+				total += s.p50 / period;
+				label(table, o, stringizer() + s.name + ": " + s.p50 + " / " + s.p95 + " us");
+				bar(table, o, total); // stacked with all the previous systems
+			}
+		}
+
+		{ // entities
+			uint32 o = 0;
+			const uint32 table = section(root, order, "entities");
+			row(table, o, "all", stringizer() + statistics.entitiesCurrent);
+			row(table, o, "monsters", stringizer() + statistics.monstersCurrent);
+			row(table, o, "shots", stringizer() + statistics.shotsCurrent);
+			row(table, o, "timeouts", stringizer() + TimeoutComponent::component->group()->count());
+			row(table, o, "renders", stringizer() + RenderComponent::component->group()->count());
+			row(table, o, "particles", stringizer() + statistics.particlesCurrent);
+			row(table, o, "grid awake", stringizer() + statistics.gridMarkersAwake + " / " + (statistics.gridMarkersAwake + statistics.gridMarkersAsleep));
+		}
+
+		{ // spatial queries
+			uint32 o = 0;
+			const uint32 table = section(root, order, "spatial queries");
+			for (uint32 i = 0; i < (uint32)SpatialSiteEnum::Total; i++)
+				row(table, o, SpatialSiteShortName[i], stringizer() + statistics.spatialQueriesCurrent[i] + " / " + statistics.spatialResultsCurrent[i] + " / " + statistics.spatialUsedCurrent[i]);
+		}
+
+		{ // budgets
+			uint32 o = 0;
+			const uint32 table = section(root, order, stringizer() + "quality level: " + qualityLevel());
+			label(table, o, stringizer() + "lights: " + statistics.lightsCurrent + " / " + (uint32)confLightsBudget);
+			bar(table, o, real(statistics.lightsCurrent) / max((uint32)confLightsBudget, 1u));
+			label(table, o, stringizer() + "voices: " + statistics.soundVoicesCurrent + " / " + (uint32)confVoicesBudget);
+			bar(table, o, real(statistics.soundVoicesCurrent) / max((uint32)confVoicesBudget, 1u));
+		}
+	}
+
+	void engineUpdate()
+	{
+		DEGRID_SYSTEM_TIMING("overlay");
+
+		EntityManager *ents = engineGui()->entities();
+		if (!confOverlayEnabled)
+		{
+			if (namesUsed)
+				clear();
+			return;
+		}
+		// the overlay is lost whenever the screen regenerates the gui
+		if (namesUsed && ents->has(OverlayNames) && statistics.updateIterationIgnorePause % OverlayRefresh != 0)
+			return;
+		clear();
+		generate();
+	}
+
+	class Callbacks
+	{
+		EventListener<void()> engineUpdateListener;
+	public:
+		Callbacks() : engineUpdateListener("overlay")
+		{
+			engineUpdateListener.attach(controlThread().update, 61); // after gui
+			engineUpdateListener.bind<&engineUpdate>();
+		}
+	} callbacksInstance;
+}
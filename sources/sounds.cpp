@@ -1,26 +1,267 @@
-#include <cage-core/geometry.h>
 #include <cage-core/entities.h>
 #include <cage-core/config.h>
 #include <cage-core/assetManager.h>
-#include <cage-core/spatialStructure.h>
 #include <cage-core/hashString.h>
 #include <cage-engine/sound.h>
 
 #include "game.h"
 
+#include <vector>
+#include <unordered_map>
+
 extern ConfigFloat confVolumeMusic;
 extern ConfigFloat confVolumeEffects;
 extern ConfigFloat confVolumeSpeech;
 
+ConfigUint32 confVoicesBudget("degrid/sounds/voices", 24);
+
+Entity *getPrimaryCameraEntity();
+
 namespace
 {
+	struct SoundMetadata
+	{
+		uint64 duration = 0;
+		uint32 channels = 0;
+		bool loaded = false;
+	};
+
+	std::unordered_map<uint32, SoundMetadata> soundMetadata;
+
+	// packs containing sounds, the metadata are refreshed whenever any of them is loaded or released
+	constexpr const uint32 SoundPacks[] = {
+		HashString("degrid/player/player.pack"),
+		HashString("degrid/monster/monster.pack"),
+		HashString("degrid/monster/shocker/shocker.pack"),
+		HashString("degrid/monster/wormhole.pack"),
+		HashString("degrid/boss/boss.pack"),
+		HashString("degrid/music/music.pack"),
+		HashString("degrid/speech/speech.pack"),
+	};
+	constexpr uint32 SoundPacksCount = sizeof(SoundPacks) / sizeof(SoundPacks[0]);
+	static_assert(SoundPacksCount <= 32, "too many sound packs");
+	uint32 soundPacksLoaded = 0; // bit per pack
+
+	void soundMetadataFill(uint32 soundName, SoundMetadata &m)
+	{
+		Holder<Sound> src = engineAssets()->get<AssetSchemeIndexSound, Sound>(soundName);
+		m.loaded = !!src;
+		if (!src)
+			return;
+		m.duration = src->duration();
+		m.channels = src->channels();
+	}
+
+	void soundMetadataRefresh()
+	{
+		uint32 loaded = 0;
+		for (uint32 i = 0; i < SoundPacksCount; i++)
+			if (engineAssets()->get<AssetSchemeIndexPack, AssetPack>(SoundPacks[i]))
+				loaded |= 1u << i;
+		if (loaded == soundPacksLoaded)
+			return;
+		soundPacksLoaded = loaded;
+		for (auto &it : soundMetadata)
+			soundMetadataFill(it.first, it.second);
+	}
+
+	// sounds not yet loaded are filled in when their pack finishes loading
+	const SoundMetadata *soundMetadataFind(uint32 soundName)
+	{
+		auto it = soundMetadata.find(soundName);
+		if (it == soundMetadata.end())
+		{
+			it = soundMetadata.emplace(soundName, SoundMetadata()).first;
+			soundMetadataFill(soundName, it->second);
+		}
+		return it->second.loaded ? &it->second : nullptr;
+	}
+
+	constexpr uint32 VoicesPerSound = 3; // concurrent instances of same sound effect
+	constexpr float VoiceDistanceMax = 500; // from the listener
+
+	struct Voice
+	{
+		Entity *entity = nullptr;
+		uint64 endTime = 0;
+		uint32 name = 0; // zero when the voice is free
+		real distance; // to the listener when started, closer voices are more important
+		SoundPriorityEnum priority = SoundPriorityEnum::Debris;
+
+		// whether this voice is less important than the other one
+		bool lessImportant(SoundPriorityEnum otherPriority, real otherDistance) const
+		{
+			if (priority != otherPriority)
+				return priority < otherPriority;
+			return distance > otherDistance;
+		}
+	};
+
+	std::vector<Voice> voices;
+
+	void voiceRelease(Voice &v)
+	{
+		v.entity->remove(SoundComponent::component);
+		v.name = 0;
+	}
+
+	// returns the voice to (re)use or nullptr if the effect should not be played
+	Voice *voiceAcquire(uint32 soundName, SoundPriorityEnum priority, real dist)
+	{
+		uint32 active = 0, sameName = 0;
+		Voice *freeVoice = nullptr, *worstAll = nullptr, *worstSame = nullptr;
+		for (Voice &v : voices)
+		{
+			if (v.name == 0)
+			{
+				freeVoice = &v;
+				continue;
+			}
+			active++;
+			if (!worstAll || v.lessImportant(worstAll->priority, worstAll->distance))
+				worstAll = &v;
+			if (v.name == soundName)
+			{
+				sameName++;
+				if (!worstSame || v.lessImportant(worstSame->priority, worstSame->distance))
+					worstSame = &v;
+			}
+		}
+
+		Voice *steal = nullptr;
+		if (sameName >= VoicesPerSound)
+			steal = worstSame;
+		else if (active >= (uint32)confVoicesBudget)
+			steal = worstAll;
+		if (steal)
+		{
+			if (!steal->lessImportant(priority, dist))
+				return nullptr;
+			statistics.soundEffectsStolen++;
+			return steal;
+		}
+
+		if (freeVoice)
+			return freeVoice;
+		voices.emplace_back();
+		Voice &v = voices.back();
+		v.entity = engineEntities()->createAnonymous();
+		return &v;
+	}
+
+	void voicesUpdate()
+	{
+		const uint64 time = engineControlTime();
+		uint32 active = 0;
+		for (Voice &v : voices)
+		{
+			if (v.name && v.endTime <= time)
+				voiceRelease(v);
+			if (v.name)
+				active++;
+		}
+		statistics.soundVoicesCurrent = active;
+	}
+
+	constexpr uint32 SpeechQueueLength = 3;
+	constexpr uint64 SpeechStaleTime = 3000000; // us
+
+	struct SpeechRequest
+	{
+		uint64 time = 0;
+		uint32 name = 0;
+		SpeechCategoryEnum category = SpeechCategoryEnum::Progress;
+	};
+
+	std::vector<SpeechRequest> speechQueue;
+	SpeechRequest speechActive; // name is zero when nothing is playing
+	uint64 speechEndTime = 0;
+	Entity *speechEnt;
+
+	void speechStart(const SpeechRequest &r)
+	{
+		const SoundMetadata *src = soundMetadataFind(r.name);
+		if (!src)
+			return;
+		if (!speechEnt)
+			speechEnt = engineEntities()->createAnonymous();
+		CAGE_COMPONENT_ENGINE(Sound, s, speechEnt);
+		s.name = r.name;
+		s.startTime = engineControlTime();
+		s.gain = (real)confVolumeSpeech;
+		speechActive = r;
+		speechEndTime = engineControlTime() + src->duration + 100000;
+		statistics.speechPlayed++;
+	}
+
+	void speechUpdate()
+	{
+		const uint64 time = engineControlTime();
+		if (speechActive.name && speechEndTime <= time)
+		{
+			speechEnt->remove(SoundComponent::component);
+			speechActive.name = 0;
+		}
+
+		uint32 i = 0;
+		while (i < speechQueue.size())
+		{
+			if (speechQueue[i].time + SpeechStaleTime < time)
+			{
+				speechQueue.erase(speechQueue.begin() + i);
+				statistics.speechExpired++;
+			}
+			else
+				i++;
+		}
+
+		if (speechActive.name || speechQueue.empty())
+			return;
+		uint32 best = 0;
+		for (uint32 j = 1; j < speechQueue.size(); j++)
+			if (speechQueue[j].category > speechQueue[best].category)
+				best = j; // ties keep the oldest request
+		const SpeechRequest r = speechQueue[best];
+		speechQueue.erase(speechQueue.begin() + best);
+		speechStart(r);
+	}
+
 	real suspense;
 	real suspenseVolume;
 	real actionVolume;
 	real endVolume;
-	Entity *suspenseEnt;
-	Entity *actionEnt;
-	Entity *endEnt;
+
+	// silent layer has no sound component so that it is not decoded nor mixed
+	struct MusicLayer
+	{
+		Entity *entity = nullptr;
+		uint64 startTime = 0; // preserved while silent to resume in sync
+		uint32 name = 0;
+
+		void init(uint32 soundName)
+		{
+			entity = engineEntities()->createUnique();
+			startTime = engineControlTime();
+			name = soundName;
+		}
+
+		void gain(real g)
+		{
+			if (g <= 1e-5)
+			{
+				entity->remove(SoundComponent::component);
+				return;
+			}
+			CAGE_COMPONENT_ENGINE(Sound, s, entity);
+			s.name = name;
+			s.startTime = startTime;
+			s.gain = g;
+		}
+	};
+
+	MusicLayer suspenseLayer;
+	MusicLayer actionLayer;
+	MusicLayer endLayer;
 
 	void determineSuspense()
 	{
@@ -35,25 +276,10 @@ namespace
 			return;
 		}
 
-		constexpr const float distMin = 30;
-		constexpr const float distMax = 60;
-		CAGE_COMPONENT_ENGINE(Transform, playerTransform, game.playerEntity);
-		real closestMonsterToPlayer = real::Infinity();
-		spatialSearchQuery->intersection(Sphere(playerTransform.position, distMax));
-		for (uint32 otherName : spatialSearchQuery->result())
-		{
-			Entity *e = engineEntities()->get(otherName);
-			if (e->has(MonsterComponent::component))
-			{
-				CAGE_COMPONENT_ENGINE(Transform, p, e);
-				real d = distance(p.position, playerTransform.position);
-				closestMonsterToPlayer = min(closestMonsterToPlayer, d);
-			}
-		}
 		// hysteresis
-		if (closestMonsterToPlayer < distMin)
+		if (playerProximity.within[0] > 0)
 			suspense = 0;
-		else if (closestMonsterToPlayer > distMax)
+		else if (playerProximity.within[1] == 0)
 			suspense = 1;
 	}
 
@@ -90,30 +316,30 @@ namespace
 
 	void engineUpdate()
 	{
-		OPTICK_EVENT("sound");
+		DEGRID_SYSTEM_TIMING("sound");
 
+		soundMetadataRefresh();
 		determineSuspense();
 		determineVolumes();
+		voicesUpdate();
+		speechUpdate();
 
-		suspenseEnt->value<SoundComponent>(SoundComponent::component).gain = suspenseVolume * (real)confVolumeMusic;
-		actionEnt->value<SoundComponent>(SoundComponent::component).gain = actionVolume * (real)confVolumeMusic;
-		endEnt->value<SoundComponent>(SoundComponent::component).gain = endVolume * (real)confVolumeMusic;
-	}
-
-	Entity *initEntity(const uint32 soundName)
-	{
-		Entity *e = engineEntities()->createUnique();
-		CAGE_COMPONENT_ENGINE(Sound, s, e);
-		s.gain = 0;
-		s.name = soundName;
-		return e;
+		suspenseLayer.gain(suspenseVolume * (real)confVolumeMusic);
+		actionLayer.gain(actionVolume * (real)confVolumeMusic);
+		endLayer.gain(endVolume * (real)confVolumeMusic);
 	}
 
 	void gameStart()
 	{
-		suspenseEnt = initEntity(HashString("degrid/music/fear-and-horror.ogg"));
-		actionEnt = initEntity(HashString("degrid/music/chaotic-filth.ogg"));
-		endEnt = initEntity(HashString("degrid/music/sad-song.ogg"));
+		// the pooled entities are destroyed with all other entities
+		voices.clear();
+		speechEnt = nullptr;
+		speechActive.name = 0;
+		speechQueue.clear();
+
+		suspenseLayer.init(HashString("degrid/music/fear-and-horror.ogg"));
+		actionLayer.init(HashString("degrid/music/chaotic-filth.ogg"));
+		endLayer.init(HashString("degrid/music/sad-song.ogg"));
 
 		if (!game.cinematic)
 		{
@@ -130,7 +356,7 @@ namespace
 				HashString("degrid/speech/starts/ready-set-go.wav"),
 				0
 			};
-			soundSpeech(Sounds);
+			soundSpeech(Sounds, SpeechCategoryEnum::Game);
 		}
 	}
 
@@ -144,7 +370,7 @@ namespace
 			HashString("degrid/speech/gameover/thats-it.wav"),
 			0
 		};
-		soundSpeech(Sounds);
+		soundSpeech(Sounds, SpeechCategoryEnum::Game);
 	}
 
 	class Callbacks
@@ -165,43 +391,84 @@ namespace
 	} callbacksInstance;
 }
 
-void soundEffect(uint32 soundName, const vec3 &position)
+void soundEffect(uint32 soundName, const vec3 &position, SoundPriorityEnum priority)
 {
-	Holder<Sound> src = engineAssets()->get<AssetSchemeIndexSound, Sound>(soundName);
+	real dist = 0;
+	if (Entity *listener = getPrimaryCameraEntity())
+	{
+		CAGE_COMPONENT_ENGINE(Transform, lt, listener);
+		dist = distance(lt.position, position);
+	}
+	if (dist > VoiceDistanceMax)
+	{
+		statistics.soundEffectsDropped++;
+		return;
+	}
+	const SoundMetadata *src = soundMetadataFind(soundName);
 	if (!src)
 		return;
-	Entity *e = engineEntities()->createUnique();
+	Voice *v = voiceAcquire(soundName, priority, dist);
+	if (!v)
+	{
+		statistics.soundEffectsDropped++;
+		return;
+	}
+	v->name = soundName;
+	v->distance = dist;
+	v->priority = priority;
+	v->endTime = engineControlTime() + src->duration + 100000;
+	Entity *e = v->entity;
 	CAGE_COMPONENT_ENGINE(Transform, t, e);
 	t.position = position;
+	e->remove(TransformComponent::componentHistory);
 	CAGE_COMPONENT_ENGINE(Sound, s, e);
 	s.name = soundName;
 	s.startTime = engineControlTime();
 	s.gain = (real)confVolumeEffects;
-	DEGRID_COMPONENT(Timeout, ttl, e);
-	ttl.ttl = numeric_cast<uint32>((src->duration() + 100000) / controlThread().updatePeriod());
-	e->add(entitiesPhysicsEvenWhenPaused);
 }
 
-void soundSpeech(uint32 soundName)
+void soundSpeech(uint32 soundName, SpeechCategoryEnum category)
 {
-	Holder<Sound> src = engineAssets()->get<AssetSchemeIndexSound, Sound>(soundName);
-	if (!src)
+	if (speechActive.name == soundName)
+	{
+		statistics.speechCoalesced++;
 		return;
-	Entity* e = engineEntities()->createUnique();
-	CAGE_COMPONENT_ENGINE(Sound, s, e);
-	s.name = soundName;
-	s.startTime = engineControlTime();
-	s.gain = (real)confVolumeSpeech;
-	DEGRID_COMPONENT(Timeout, ttl, e);
-	ttl.ttl = numeric_cast<uint32>((src->duration() + 100000) / controlThread().updatePeriod());
-	e->add(entitiesPhysicsEvenWhenPaused);
+	}
+	SpeechRequest r;
+	r.time = engineControlTime();
+	r.name = soundName;
+	r.category = category;
+	for (SpeechRequest &q : speechQueue)
+	{
+		if (q.name == soundName || q.category == category)
+		{
+			q = r; // keep only the latest line of each category
+			statistics.speechCoalesced++;
+			return;
+		}
+	}
+	if (speechQueue.size() >= SpeechQueueLength)
+	{
+		uint32 worst = 0;
+		for (uint32 j = 1; j < speechQueue.size(); j++)
+			if (speechQueue[j].category < speechQueue[worst].category)
+				worst = j;
+		if (speechQueue[worst].category >= category)
+		{
+			statistics.speechDropped++;
+			return;
+		}
+		speechQueue.erase(speechQueue.begin() + worst);
+		statistics.speechReplaced++;
+	}
+	speechQueue.push_back(r);
 }
 
-void soundSpeech(const uint32 sounds[])
+void soundSpeech(const uint32 sounds[], SpeechCategoryEnum category)
 {
 	const uint32 *p = sounds;
 	uint32 count = 0;
 	while (*p++)
 		count++;
-	soundSpeech(sounds[randomRange(0u, count)]);
+	soundSpeech(sounds[randomRange(0u, count)], category);
 }
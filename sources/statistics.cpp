@@ -2,11 +2,16 @@
 #include <cage-core/entities.h>
 #include <cage-core/hashString.h>
 #include <cage-core/macros.h>
+#include <cage-core/config.h>
+#include <cage-core/ini.h>
 #include <cage-engine/window.h>
 #include <cage-engine/engineProfiling.h>
 
 #include "game.h"
 
+#include <vector>
+#include <algorithm>
+
 GlobalStatistics statistics;
 
 GlobalStatistics::GlobalStatistics()
@@ -17,14 +22,43 @@ GlobalStatistics::GlobalStatistics()
 
 namespace
 {
+	ConfigBool confReportEnabled("degrid/report/enabled", false);
+	ConfigString confReportPath("degrid/report/path", "report.ini");
+
+	Holder<Ini> report;
+	std::vector<uint32> renderTimes;
+	std::vector<uint32> updateTimes;
+
+	void reportValue(const string &section, const string &item, const string &value)
+	{
+		if (report)
+			report->setString(section, item, value);
+	}
+
+	void reportPercentiles(const string &name, std::vector<uint32> &values)
+	{
+		if (values.empty())
+			return;
+		constexpr const uint32 Percentiles[] = { 50, 90, 95, 99, 100 };
+		for (uint32 p : Percentiles)
+		{
+			const auto it = values.begin() + (values.size() - 1) * p / 100;
+			std::nth_element(values.begin(), it, values.end());
+			reportValue("times", stringizer() + name + ".p" + p, stringizer() + *it);
+		}
+	}
+
 	void engineUpdate()
 	{
-		OPTICK_EVENT("statistics");
+		DEGRID_SYSTEM_TIMING("statistics");
 
 		statistics.updateIterationIgnorePause++;
 		if (!game.paused)
 			statistics.updateIteration++;
 
+		for (uint32 i = 0; i < (uint32)SpatialSiteEnum::Total; i++)
+			statistics.spatialQueriesCurrent[i] = statistics.spatialResultsCurrent[i] = statistics.spatialUsedCurrent[i] = 0;
+
 		if (game.gameOver)
 			return;
 
@@ -35,6 +69,8 @@ namespace
 		statistics.entitiesCurrent = engineEntities()->group()->count();
 		statistics.entitiesMax = max(statistics.entitiesMax, statistics.entitiesCurrent);
 		statistics.timeRenderCurrent = engineProfilingValues(EngineProfilingStatsFlags::FrameTime, EngineProfilingModeEnum::Last);
+		statistics.timeRenderCostCurrent = engineProfilingValues(EngineProfilingStatsFlags::GraphicsPrepare | EngineProfilingStatsFlags::GraphicsDispatch, EngineProfilingModeEnum::Last);
+		statistics.timeUpdateCurrent = engineProfilingValues(EngineProfilingStatsFlags::Control, EngineProfilingModeEnum::Last);
 		if (statistics.updateIterationIgnorePause > 1000)
 		{
 			statistics.timeRenderMin = min(statistics.timeRenderMin, statistics.timeRenderCurrent);
@@ -42,12 +78,22 @@ namespace
 		}
 		statistics.soundEffectsCurrent = SoundComponent::component->group()->count();
 		statistics.soundEffectsMax = max(statistics.soundEffectsMax, statistics.soundEffectsCurrent);
+		if (report)
+		{
+			renderTimes.push_back(numeric_cast<uint32>(statistics.timeRenderCurrent));
+			updateTimes.push_back(numeric_cast<uint32>(statistics.timeUpdateCurrent));
+		}
 	}
 
 	void gameStart()
 	{
 		statistics = GlobalStatistics();
 		statistics.timeStart = applicationTime();
+		report.clear();
+		if (confReportEnabled && !game.cinematic)
+			report = newIni();
+		renderTimes.clear();
+		updateTimes.clear();
 	}
 
 	void gameStop()
@@ -70,10 +116,13 @@ namespace
 			"Coin"
 		};
 		for (uint32 i = 0; i < (uint32)PowerupTypeEnum::Total; i++)
+		{
 			if (game.powerups[i] > 0)
 				CAGE_LOG(SeverityEnum::Info, "statistics", stringizer() + "powerup '" + PowerupName[i] + "': " + game.powerups[i]);
+			reportValue("powerups", PowerupName[i], stringizer() + game.powerups[i]);
+		}
 
-#define GCHL_GENERATE(N) if (statistics.N != 0) CAGE_LOG(SeverityEnum::Info, "statistics", stringizer() + CAGE_STRINGIZE(N) ": " + statistics.N);
+#define GCHL_GENERATE(N) if (statistics.N != 0) CAGE_LOG(SeverityEnum::Info, "statistics", stringizer() + CAGE_STRINGIZE(N) ": " + statistics.N); reportValue("statistics", CAGE_STRINGIZE(N), stringizer() + statistics.N);
 		CAGE_EVAL_SMALL(CAGE_EXPAND_ARGS(GCHL_GENERATE, \
 			shotsFired, shotsTurret, shotsHit, shotsKill, shotsCurrent, shotsMax, \
 			monstersSpawned, monstersMutated, monstersMutations, monstersSucceded, monstersCurrent, monstersMax, monstersCurrentSpawningPriority, monstersFirstHit, \
@@ -82,14 +131,24 @@ namespace
 			powerupsSpawned, coinsSpawned, powerupsPicked, powerupsWasted, \
 			bombsUsed, bombsHitTotal, bombsKillTotal, bombsHitMax, bombsKillMax \
 		));
+		CAGE_EVAL_SMALL(CAGE_EXPAND_ARGS(GCHL_GENERATE, \
+			killsQueued, killExplosionsCoalesced, killSoundsCoalesced, monstersLastHit, \
+			soundVoicesCurrent, spatialItemsCurrent, \
+			particlesCurrent, particlesMax, particlesDropped, \
+			lightsCurrent, lightsMax, lightsMerged, lightsDropped, \
+			qualityLevel, qualityLevelMax, qualityChanges \
+		));
 		CAGE_EVAL_SMALL(CAGE_EXPAND_ARGS(GCHL_GENERATE, \
 			shieldStoppedMonsters, shieldAbsorbedDamage, turretsPlaced, decoysUsed, \
 			entitiesCurrent, entitiesMax, \
-			environmentGridMarkers, environmentExplosions, \
+			environmentGridMarkers, gridMarkersAwake, gridMarkersAsleep, gridChunksActive, gridChunksActivations, gridChunksDeactivations, environmentExplosions, \
 			keyPressed, buttonPressed, \
 			updateIteration, updateIterationIgnorePause, frameIteration, \
-			timeRenderMin, timeRenderMax, timeRenderCurrent, \
-			soundEffectsCurrent, soundEffectsMax \
+			timeRenderMin, timeRenderMax, timeRenderCurrent, timeRenderCostCurrent, timeUpdateCurrent \
+		));
+		CAGE_EVAL_SMALL(CAGE_EXPAND_ARGS(GCHL_GENERATE, \
+			soundEffectsCurrent, soundEffectsMax, soundEffectsDropped, soundEffectsStolen, \
+			speechPlayed, speechCoalesced, speechDropped, speechReplaced, speechExpired \
 		));
 #undef GCHL_GENERATE
 
@@ -97,6 +156,98 @@ namespace
 		CAGE_LOG(SeverityEnum::Info, "statistics", stringizer() + "duration: " + (duration / 1e6) + " s");
 		CAGE_LOG(SeverityEnum::Info, "statistics", stringizer() + "average UPS: " + (1e6 * statistics.updateIterationIgnorePause / duration));
 		CAGE_LOG(SeverityEnum::Info, "statistics", stringizer() + "average FPS: " + (1e6 * statistics.frameIteration / duration));
+		reportValue("statistics", "duration", stringizer() + duration);
+		reportValue("statistics", "averageUps", stringizer() + (1e6 * statistics.updateIterationIgnorePause / duration));
+		reportValue("statistics", "averageFps", stringizer() + (1e6 * statistics.frameIteration / duration));
+		reportValue("game", "score", stringizer() + game.score);
+		reportValue("game", "defeatedBosses", stringizer() + game.defeatedBosses);
+		reportValue("game", "money", stringizer() + game.money);
+
+		static const string SpatialSiteName[(uint32)SpatialSiteEnum::Total] = {
+			"MonstersDispersion",
+			"SimpleMonstersAvoidance",
+			"ShielderShots",
+			"Wormhole",
+			"Shots"
+		};
+		for (uint32 i = 0; i < (uint32)SpatialSiteEnum::Total; i++)
+		{
+			if (statistics.spatialQueries[i] > 0)
+				CAGE_LOG(SeverityEnum::Info, "statistics", stringizer() + "spatial '" + SpatialSiteName[i] + "', queries: " + statistics.spatialQueries[i] + ", results: " + statistics.spatialResults[i] + ", used: " + statistics.spatialUsed[i] + ", queries per tick: " + (real(statistics.spatialQueries[i]) / max(statistics.updateIteration, 1u)));
+			reportValue("spatial", SpatialSiteName[i] + ".queries", stringizer() + statistics.spatialQueries[i]);
+			reportValue("spatial", SpatialSiteName[i] + ".results", stringizer() + statistics.spatialResults[i]);
+			reportValue("spatial", SpatialSiteName[i] + ".used", stringizer() + statistics.spatialUsed[i]);
+		}
+
+		static const string ChurnCategoryName[(uint32)ChurnCategoryEnum::Total] = {
+			"Entities",
+			"Monsters",
+			"Shots",
+			"Powerups",
+			"Timeouts",
+			"LightSources",
+			"Lights",
+			"Sounds",
+			"Renders"
+		};
+		for (uint32 i = 0; i < (uint32)ChurnCategoryEnum::Total; i++)
+		{
+			if (statistics.churnCreated[i] + statistics.churnDestroyed[i] > 0)
+				CAGE_LOG(SeverityEnum::Info, "statistics", stringizer() + "churn '" + ChurnCategoryName[i] + "', created: " + statistics.churnCreated[i] + " (peak " + statistics.churnCreatedPeak[i] + "), destroyed: " + statistics.churnDestroyed[i] + " (peak " + statistics.churnDestroyedPeak[i] + ")");
+			reportValue("churn", ChurnCategoryName[i] + ".created", stringizer() + statistics.churnCreated[i]);
+			reportValue("churn", ChurnCategoryName[i] + ".createdPeak", stringizer() + statistics.churnCreatedPeak[i]);
+			reportValue("churn", ChurnCategoryName[i] + ".destroyed", stringizer() + statistics.churnDestroyed[i]);
+			reportValue("churn", ChurnCategoryName[i] + ".destroyedPeak", stringizer() + statistics.churnDestroyedPeak[i]);
+			reportValue("churn", ChurnCategoryName[i] + ".createdCurrent", stringizer() + statistics.churnCreatedCurrent[i]);
+			reportValue("churn", ChurnCategoryName[i] + ".destroyedCurrent", stringizer() + statistics.churnDestroyedCurrent[i]);
+			reportValue("churn", ChurnCategoryName[i] + ".createdAverage", stringizer() + statistics.churnCreatedAverage[i]);
+			reportValue("churn", ChurnCategoryName[i] + ".destroyedAverage", stringizer() + statistics.churnDestroyedAverage[i]);
+		}
+
+		for (uint32 i = 0; i < systemTimingCount(); i++)
+		{
+			const SystemTimingPercentiles p = systemTimingPercentiles(i);
+			if (p.samples == 0)
+				continue;
+			CAGE_LOG(SeverityEnum::Info, "statistics", stringizer() + "system '" + systemTimingName(i) + "' us, p50: " + p.p50 + ", p95: " + p.p95 + ", p99: " + p.p99 + ", max: " + p.max);
+			const string name = systemTimingName(i);
+			reportValue("systems", name + ".p50", stringizer() + p.p50);
+			reportValue("systems", name + ".p95", stringizer() + p.p95);
+			reportValue("systems", name + ".p99", stringizer() + p.p99);
+			reportValue("systems", name + ".max", stringizer() + p.max);
+		}
+
+		if (!report)
+			return;
+
+		reportPercentiles("render", renderTimes);
+		reportPercentiles("update", updateTimes);
+
+#ifdef DEGRID_REVISION
+		reportValue("build", "revision", DEGRID_REVISION);
+#endif // DEGRID_REVISION
+#ifdef CAGE_DEBUG
+		reportValue("build", "configuration", "debug");
+#else
+		reportValue("build", "configuration", "release");
+#endif // CAGE_DEBUG
+#ifdef DEGRID_TESTING
+		reportValue("build", "testing", "true");
+#else
+		reportValue("build", "testing", "false");
+#endif // DEGRID_TESTING
+		reportValue("build", "pointerBits", stringizer() + (uint32)(sizeof(void *) * 8));
+		reportValue("build", "updatePeriod", stringizer() + controlThread().updatePeriod());
+
+		try
+		{
+			report->exportFile(confReportPath);
+		}
+		catch (...)
+		{
+			CAGE_LOG(SeverityEnum::Warning, "statistics", "failed to save the game report");
+		}
+		report.clear();
 	}
 
 	class Callbacks
@@ -116,3 +267,8 @@ namespace
 		}
 	} callbacksInstance;
 }
+
+Ini *gameReport()
+{
+	return +report;
+}
@@ -0,0 +1,87 @@
+#include <cage-core/files.h>
+#include <cage-core/config.h>
+
+#include "game.h"
+#include "telemetry.h"
+
+namespace
+{
+	ConfigBool confTelemetryEnabled("degrid/telemetry/enabled", false);
+	ConfigUint32 confTelemetryPeriod("degrid/telemetry/period", 1); // ticks
+	ConfigString confTelemetryPath("degrid/telemetry/path", "telemetry.bin");
+
+	Holder<File> file;
+	uint32 period = 1;
+
+	template<class T>
+	void write(const T &v)
+	{
+		file->write({ (const char *)&v, (const char *)(&v + 1) });
+	}
+
+	void engineUpdate()
+	{
+		DEGRID_SYSTEM_TIMING("telemetry");
+
+		if (!file || statistics.updateIterationIgnorePause % period != 0)
+			return;
+
+		TelemetryRecord r;
+		r.timeRender = statistics.timeRenderCurrent;
+		r.timeUpdate = statistics.timeUpdateCurrent;
+		r.updateIteration = statistics.updateIterationIgnorePause;
+		r.entities = statistics.entitiesCurrent;
+		r.monsters = statistics.monstersCurrent;
+		r.shots = statistics.shotsCurrent;
+		r.sounds = statistics.soundEffectsCurrent;
+		r.spawningPriority = statistics.monstersCurrentSpawningPriority.value;
+		write(r);
+	}
+
+	void gameStart()
+	{
+		file.clear();
+		if (!confTelemetryEnabled || game.cinematic)
+			return;
+		period = max((uint32)confTelemetryPeriod, 1u);
+		try
+		{
+			file = newFile(confTelemetryPath, FileMode(false, true));
+			TelemetryHeader h;
+			h.recordSize = sizeof(TelemetryRecord);
+			h.fieldsCount = sizeof(TelemetryFields) / sizeof(TelemetryFields[0]);
+			h.updatePeriod = numeric_cast<uint32>(controlThread().updatePeriod());
+			h.recordsPeriod = period;
+			write(h);
+			for (const TelemetryField &f : TelemetryFields)
+				write(f);
+		}
+		catch (...)
+		{
+			CAGE_LOG(SeverityEnum::Warning, "telemetry", "failed to open the telemetry file");
+			file.clear();
+		}
+	}
+
+	void gameStop()
+	{
+		file.clear();
+	}
+
+	class Callbacks
+	{
+		EventListener<void()> engineUpdateListener;
+		EventListener<void()> gameStartListener;
+		EventListener<void()> gameStopListener;
+	public:
+		Callbacks() : engineUpdateListener("telemetry"), gameStartListener("telemetry"), gameStopListener("telemetry")
+		{
+			engineUpdateListener.attach(controlThread().update, -58); // after statistics
+			engineUpdateListener.bind<&engineUpdate>();
+			gameStartListener.attach(gameStartEvent(), -58);
+			gameStartListener.bind<&gameStart>();
+			gameStopListener.attach(gameStopEvent(), 60);
+			gameStopListener.bind<&gameStop>();
+		}
+	} callbacksInstance;
+}
@@ -0,0 +1,57 @@
+#include <cage-core/core.h>
+
+#include <cstddef>
+
+using namespace cage;
+
+// telemetry file layout: TelemetryHeader, then header.fieldsCount of TelemetryField, then records of header.recordSize bytes each
+
+enum class TelemetryTypeEnum : uint32
+{
+	Uint32,
+	Uint64,
+	Float,
+};
+
+struct TelemetryHeader
+{
+	char magic[8] = { 'd', 'e', 'g', 'r', 'i', 'd', 't', 'm' };
+	uint32 version = 1;
+	uint32 recordSize = 0;
+	uint32 fieldsCount = 0;
+	uint32 updatePeriod = 0; // us
+	uint32 recordsPeriod = 0; // ticks between records
+	uint32 reserved = 0;
+};
+
+struct TelemetryField
+{
+	char name[24] = {};
+	uint32 offset = 0;
+	TelemetryTypeEnum type = TelemetryTypeEnum::Uint32;
+};
+
+struct TelemetryRecord
+{
+	uint64 timeRender; // us
+	uint64 timeUpdate; // us
+	uint32 updateIteration; // ticks, ignoring pause
+	uint32 entities;
+	uint32 monsters;
+	uint32 shots;
+	uint32 sounds;
+	float spawningPriority;
+};
+
+#define DEGRID_TELEMETRY_FIELD(NAME, TYPE) { #NAME, offsetof(TelemetryRecord, NAME), TelemetryTypeEnum::TYPE }
+constexpr const TelemetryField TelemetryFields[] = {
+	DEGRID_TELEMETRY_FIELD(updateIteration, Uint32),
+	DEGRID_TELEMETRY_FIELD(timeRender, Uint64),
+	DEGRID_TELEMETRY_FIELD(timeUpdate, Uint64),
+	DEGRID_TELEMETRY_FIELD(entities, Uint32),
+	DEGRID_TELEMETRY_FIELD(monsters, Uint32),
+	DEGRID_TELEMETRY_FIELD(shots, Uint32),
+	DEGRID_TELEMETRY_FIELD(sounds, Uint32),
+	DEGRID_TELEMETRY_FIELD(spawningPriority, Float),
+};
+#undef DEGRID_TELEMETRY_FIELD
@@ -0,0 +1,66 @@
+#include "game.h"
+
+#include <algorithm>
+#include <cstring>
+
+struct SystemTiming
+{
+	static constexpr uint32 Window = 256; // ticks
+	const char *name = nullptr;
+	uint32 durations[Window] = {};
+	uint32 recorded = 0;
+};
+
+namespace
+{
+	constexpr uint32 SystemsLimit = 64;
+	SystemTiming systems[SystemsLimit];
+	uint32 systemsCount = 0;
+}
+
+SystemTiming *systemTimingFind(const char *name)
+{
+	for (uint32 i = 0; i < systemsCount; i++)
+		if (std::strcmp(systems[i].name, name) == 0)
+			return systems + i;
+	if (systemsCount == SystemsLimit)
+		CAGE_THROW_CRITICAL(Exception, "too many timed systems");
+	SystemTiming *t = systems + systemsCount++;
+	t->name = name;
+	return t;
+}
+
+void systemTimingRecord(SystemTiming *timing, uint64 duration)
+{
+	timing->durations[timing->recorded++ % SystemTiming::Window] = (uint32)std::min<uint64>(duration, (uint32)m);
+}
+
+uint32 systemTimingCount()
+{
+	return systemsCount;
+}
+
+const char *systemTimingName(uint32 index)
+{
+	CAGE_ASSERT(index < systemsCount);
+	return systems[index].name;
+}
+
+SystemTimingPercentiles systemTimingPercentiles(uint32 index)
+{
+	CAGE_ASSERT(index < systemsCount);
+	const SystemTiming &t = systems[index];
+	SystemTimingPercentiles res;
+	res.samples = min(t.recorded, SystemTiming::Window);
+	if (res.samples == 0)
+		return res;
+	uint32 sorted[SystemTiming::Window];
+	std::copy(t.durations, t.durations + res.samples, sorted);
+	std::sort(sorted, sorted + res.samples);
+	const auto &percentile = [&](uint32 p) { return sorted[(res.samples - 1) * p / 100]; };
+	res.p50 = percentile(50);
+	res.p95 = percentile(95);
+	res.p99 = percentile(99);
+	res.max = sorted[res.samples - 1];
+	return res;
+}
@@ -0,0 +1,243 @@
+#include <cage-core/config.h>
+#include <cage-core/assetManager.h>
+#include <cage-core/files.h>
+#include <cage-core/ini.h>
+
+#include "../sources/monsters/monsters.h"
+#include "../sources/screens/screens.h"
+
+void eventBomb();
+
+namespace
+{
+	ConfigString confBenchBaseline("degrid/bench/baseline", "benchBaseline.ini");
+	ConfigString confBenchResults("degrid/bench/results", "bench.ini");
+	ConfigUint32 confBenchSeed("degrid/bench/seed", 1337);
+	ConfigUint32 confBenchTolerance("degrid/bench/tolerance", 15); // percent
+	ConfigUint32 confBenchSlack("degrid/bench/slack", 20); // us, ignores noise in very fast systems
+
+	constexpr uint32 WarmupTicks = 60; // assets and entities settle down
+	constexpr uint32 MeasuredTicks = 256; // matches the window of the system timings
+	constexpr uint32 BombPeriod = 32;
+
+	struct Scenario
+	{
+		const char *name;
+		void (*setup)();
+		void (*tick)(uint32 index); // called on each measured tick
+	};
+
+	void setupSaturatedCircles()
+	{
+		monstersSpawnDefinition("saturated circles", 0);
+	}
+
+	void setupRocketsCircle()
+	{
+		monstersSpawnDefinition("rockets circle", 50);
+	}
+
+	void setupMixedAround()
+	{
+		for (uint32 i = 0; i < 3; i++)
+			monstersSpawnDefinition("mixed around", 10);
+		monstersSpawnDefinition("individual shielders", 5);
+		monstersSpawnDefinition("individual shockers", 5);
+	}
+
+	void setupWormholes()
+	{
+		monstersSpawnDefinition("wormholes", 4);
+		monstersSpawnDefinition("circle groups", 60);
+	}
+
+	void setupCannoneer()
+	{
+		CAGE_COMPONENT_ENGINE(Transform, p, game.playerEntity);
+		spawnBossCannoneer(p.position + vec3(0, 0, -150), vec3(0.5));
+	}
+
+	void tickBomb(uint32 index)
+	{
+		if (index % BombPeriod != 0)
+			return;
+		monstersSpawnDefinition("saturated circles", 0);
+		game.powerups[(uint32)PowerupTypeEnum::Bomb] = 1;
+		eventBomb();
+	}
+
+	constexpr const Scenario Scenarios[] = {
+		{ "saturated circles", &setupSaturatedCircles, nullptr },
+		{ "rockets circle", &setupRocketsCircle, nullptr },
+		{ "mixed around", &setupMixedAround, nullptr },
+		{ "wormholes", &setupWormholes, nullptr },
+		{ "cannoneer", &setupCannoneer, nullptr },
+		{ "bomb", &setupSaturatedCircles, &tickBomb },
+	};
+	constexpr uint32 ScenariosCount = sizeof(Scenarios) / sizeof(Scenarios[0]);
+
+	uint32 scenario = m; // waiting for assets
+	uint32 tick = 0;
+	uint64 tickStart = 0;
+	uint64 measuredTime = 0;
+	bool regression = false;
+	Holder<Ini> results;
+	Holder<Ini> baseline;
+
+	bool assetsReady()
+	{
+		return !!engineAssets()->get<AssetSchemeIndexPack, AssetPack>(HashString("degrid/degrid.pack"));
+	}
+
+	void scenarioStart()
+	{
+		CAGE_LOG(SeverityEnum::Info, "bench", stringizer() + "scenario: " + Scenarios[scenario].name);
+		detail::randomGenerator() = RandomGenerator(confBenchSeed, scenario);
+		setScreenGame();
+		game.paused = false; // skip the shop
+		tick = 0;
+		measuredTime = 0;
+	}
+
+	void compare(const string &section, const string &item, real value, bool higherIsBetter)
+	{
+		if (!baseline || !baseline->itemExists(section, item))
+			return;
+		const real reference = baseline->getString(section, item).toFloat();
+		const real tolerance = real((uint32)confBenchTolerance) / 100;
+		const bool worse = higherIsBetter ? value < reference * (1 - tolerance) : value > reference * (1 + tolerance) + (uint32)confBenchSlack;
+		if (!worse)
+			return;
+		CAGE_LOG(SeverityEnum::Warning, "bench", stringizer() + "regression in '" + section + "', " + item + ": " + value + ", baseline: " + reference);
+		regression = true;
+	}
+
+	void scenarioFinish()
+	{
+		const string section = Scenarios[scenario].name;
+		const real tps = real(MeasuredTicks) * 1000000 / max(measuredTime, (uint64)1);
+		CAGE_LOG(SeverityEnum::Info, "bench", stringizer() + "ticks per second: " + tps);
+		results->setString(section, "tps", stringizer() + tps);
+		compare(section, "tps", tps, true);
+		for (uint32 i = 0; i < systemTimingCount(); i++)
+		{
+			const SystemTimingPercentiles p = systemTimingPercentiles(i);
+			if (p.samples == 0)
+				continue;
+			const string item = systemTimingName(i);
+			CAGE_LOG_CONTINUE(SeverityEnum::Info, "bench", stringizer() + item + ": p50: " + p.p50 + " us, p99: " + p.p99 + " us, max: " + p.max + " us");
+			results->setString(section, item, stringizer() + p.p50);
+			compare(section, item, real(p.p50), false);
+		}
+	}
+
+	void engineUpdateBegin()
+	{
+		tickStart = applicationTime();
+	}
+
+	void engineUpdate()
+	{
+		if (scenario == m)
+		{
+			if (!assetsReady())
+				return;
+			scenario = 0;
+			scenarioStart();
+		}
+		if (scenario >= ScenariosCount)
+			return;
+
+		// the benchmark plays instead of the player
+		game.life = 1000000;
+		game.moveDirection = vec3();
+		if (game.playerEntity && MonsterComponent::component->group()->count() > 0)
+		{
+			CAGE_COMPONENT_ENGINE(Transform, p, game.playerEntity);
+			CAGE_COMPONENT_ENGINE(Transform, t, MonsterComponent::component->entities()[0]);
+			game.fireDirection = t.position - p.position;
+			game.fireDirection[1] = 0;
+			if (lengthSquared(game.fireDirection) > 1e-5)
+				game.fireDirection = normalize(game.fireDirection);
+		}
+
+		if (tick == WarmupTicks / 2)
+			Scenarios[scenario].setup();
+		if (tick >= WarmupTicks && Scenarios[scenario].tick)
+			Scenarios[scenario].tick(tick - WarmupTicks);
+	}
+
+	void frameCounter()
+	{
+		statistics.frameIteration++;
+	}
+
+	void engineUpdateEnd()
+	{
+		if (scenario >= ScenariosCount)
+			return;
+		if (tick >= WarmupTicks)
+			measuredTime += applicationTime() - tickStart;
+		if (++tick < WarmupTicks + MeasuredTicks)
+			return;
+		scenarioFinish();
+		if (++scenario < ScenariosCount)
+			scenarioStart();
+		else
+		{
+			results->exportFile(confBenchResults);
+			if (!baseline)
+				results->exportFile(confBenchBaseline); // the first run becomes the baseline
+			engineStop();
+		}
+	}
+}
+
+int main(int argc, const char *args[])
+{
+	try
+	{
+		engineInitialize(EngineCreateConfig());
+		controlThread().updatePeriod(1000000 / 30);
+		engineWindow()->title("Degrid Bench");
+		engineWindow()->setHidden();
+
+		results = newIni();
+		if (pathIsFile(confBenchBaseline))
+		{
+			baseline = newIni();
+			baseline->importFile(confBenchBaseline);
+		}
+		else
+			CAGE_LOG(SeverityEnum::Warning, "bench", stringizer() + "no baseline found, this run will become the baseline");
+
+		EventListener<void()> engineUpdateBeginListener;
+		engineUpdateBeginListener.bind<&engineUpdateBegin>();
+		engineUpdateBeginListener.attach(controlThread().update, -1000);
+		EventListener<void()> engineUpdateListener;
+		engineUpdateListener.bind<&engineUpdate>();
+		engineUpdateListener.attach(controlThread().update, -29); // after controls
+		EventListener<void()> engineUpdateEndListener;
+		engineUpdateEndListener.bind<&engineUpdateEnd>();
+		engineUpdateEndListener.attach(controlThread().update, 1000);
+		EventListener<void()> frameCounterListener;
+		frameCounterListener.bind<&frameCounter>();
+		frameCounterListener.attach(graphicsPrepareThread().prepare);
+
+		engineAssets()->add(HashString("degrid/degrid.pack"));
+		engineAssets()->add(HashString("degrid/languages/english.textpack"));
+		engineStart();
+		engineAssets()->remove(HashString("degrid/degrid.pack"));
+		engineAssets()->remove(HashString("degrid/languages/english.textpack"));
+
+		baseline.clear();
+		results.clear();
+		engineFinalize();
+		return regression ? 1 : 0;
+	}
+	catch (...)
+	{
+		detail::logCurrentCaughtException();
+	}
+	return 1;
+}
@@ -0,0 +1,118 @@
+#include <cage-core/files.h>
+#include <cage-core/logger.h>
+
+#include "../sources/telemetry.h"
+
+#include <vector>
+#include <cstring>
+
+namespace
+{
+	template<class T>
+	void read(File *f, T &v)
+	{
+		f->read({ (char *)&v, (char *)(&v + 1) });
+	}
+
+	uint32 fieldSize(TelemetryTypeEnum type)
+	{
+		switch (type)
+		{
+		case TelemetryTypeEnum::Uint32: return sizeof(uint32);
+		case TelemetryTypeEnum::Uint64: return sizeof(uint64);
+		case TelemetryTypeEnum::Float: return sizeof(float);
+		default: CAGE_THROW_ERROR(Exception, "invalid telemetry field type");
+		}
+	}
+
+	string value(const char *record, const TelemetryField &f)
+	{
+		switch (f.type)
+		{
+		case TelemetryTypeEnum::Uint32:
+		{
+			uint32 v;
+			std::memcpy(&v, record + f.offset, sizeof(v));
+			return stringizer() + v;
+		}
+		case TelemetryTypeEnum::Uint64:
+		{
+			uint64 v;
+			std::memcpy(&v, record + f.offset, sizeof(v));
+			return stringizer() + v;
+		}
+		case TelemetryTypeEnum::Float:
+		{
+			float v;
+			std::memcpy(&v, record + f.offset, sizeof(v));
+			return stringizer() + v;
+		}
+		default: CAGE_THROW_ERROR(Exception, "invalid telemetry field type");
+		}
+	}
+
+	void convert(const string &input, const string &output)
+	{
+		Holder<File> in = newFile(input, FileMode(true, false));
+		TelemetryHeader h;
+		read(+in, h);
+		if (std::memcmp(h.magic, TelemetryHeader().magic, sizeof(h.magic)) != 0)
+			CAGE_THROW_ERROR(Exception, "not a telemetry file");
+		if (h.version != TelemetryHeader().version)
+			CAGE_THROW_ERROR(Exception, "unsupported telemetry version");
+		std::vector<TelemetryField> fields(h.fieldsCount);
+		for (TelemetryField &f : fields)
+		{
+			read(+in, f);
+			f.name[sizeof(f.name) - 1] = 0;
+			const uint32 size = fieldSize(f.type); // also rejects unknown types
+			if (f.offset > h.recordSize || h.recordSize - f.offset < size)
+				CAGE_THROW_ERROR(Exception, "invalid telemetry field offset");
+		}
+
+		FileMode fm(false, true);
+		fm.textual = true;
+		Holder<File> out = newFile(output, fm);
+		{
+			string line;
+			for (const TelemetryField &f : fields)
+				line += string(line.empty() ? "" : ",") + f.name;
+			out->writeLine(line);
+		}
+		std::vector<char> record(h.recordSize);
+		uint32 count = 0;
+		while (in->size() - in->tell() >= h.recordSize)
+		{
+			in->read(record);
+			string line;
+			for (const TelemetryField &f : fields)
+				line += string(line.empty() ? "" : ",") + value(record.data(), f);
+			out->writeLine(line);
+			count++;
+		}
+		CAGE_LOG(SeverityEnum::Info, "telemetry", stringizer() + "converted " + count + " records, update period: " + h.updatePeriod + " us, records period: " + h.recordsPeriod + " ticks");
+	}
+}
+
+int main(int argc, const char *args[])
+{
+	try
+	{
+		Holder<Logger> log1 = newLogger();
+		log1->format.bind<logFormatConsole>();
+		log1->output.bind<logOutputStdOut>();
+
+		if (argc != 3)
+		{
+			CAGE_LOG(SeverityEnum::Info, "telemetry", stringizer() + "usage: " + args[0] + " telemetry.bin telemetry.csv");
+			return 1;
+		}
+		convert(args[1], args[2]);
+		return 0;
+	}
+	catch (...)
+	{
+		detail::logCurrentCaughtException();
+	}
+	return 1;
+}